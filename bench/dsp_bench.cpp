@@ -0,0 +1,609 @@
+/**
+ * Host DSP Benchmark and Regression Check
+ *
+ * Runs the audio kernels from lib/audio_dsp over 16 kHz mono 16-bit WAV
+ * corpora with the firmware's own settings (mic_config.h), reports the
+ * cost of each kernel in ns/frame, and compares the per-frame results
+ * against golden files so that optimization work cannot silently change
+ * behaviour:
+ *
+ *   VAD decision, zero crossings             must match exactly
+ *   frame energy                             within GOLDEN_ENERGY_PPM
+ *   NR and AGC output RMS                    within GOLDEN_RMS_TOLERANCE
+ *
+ * The IMA-ADPCM stream codec is timed too, and its encode/decode round trip
+ * must keep at least ADPCM_MIN_SNR_DB.
+ *
+ * A built-in noise step (quiet hiss, then a loud low-frequency rumble that
+ * passes the ZCR test) checks that the VAD lets go of a louder background
+ * within VAD_STEP_MAX_RELEASE_S instead of staying latched on.
+ *
+ * The tolerances let the float reference build (DSP_FIXED_POINT=0) pass.
+ * With --exact the energy and the CRC of the NR and AGC output must match
+ * as well, which is what the fixed-point kernels are expected to do.
+ *
+ * VAD decisions stay exact in the float build too. Both paths compare
+ * against the same integer thresholds (vadConfig, Q30/Q15), but the float
+ * path truncates a float energy onto the Q30 grid, up to ~10 ppm off the
+ * integer sum. A frame within that of a threshold can decide the other
+ * way, and through the trigger and hangover counters so can its next few
+ * frames. The shipped corpora keep clear of that. A float-only VAD mismatch
+ * whose energies are within GOLDEN_ENERGY_PPM is such a frame, not a kernel
+ * bug; the fixed-point build is the reference.
+ *
+ * The built-in "synthetic" corpus (noise with voiced bursts) needs no
+ * files, so the check also runs where no recordings are available.
+ *
+ *   pio run -e native
+ *   .pio/build/native/program [--exact] [--update] [--repeat N]
+ *                             [--golden DIR] [--synthetic] [file.wav ...]
+ *
+ * Without PlatformIO, build this file and the lib/audio_dsp sources with
+ * -I include (mic_config.h, config.h) and -I lib/audio_dsp/include; the
+ * README has the full command line.
+ *
+ * With no corpus arguments the synthetic corpus is used. Exit status is
+ * non-zero on any golden mismatch or missing golden file.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "dsp.h"
+#include "adpcm.h"
+#include "mic_config.h"
+
+#define FRAME                   AUDIO_FRAME_SIZE
+#define GOLDEN_RMS_TOLERANCE    2       // Q15 LSB, or 1 % if larger
+#define GOLDEN_ENERGY_PPM       1000    // Relative energy tolerance, plus 1 LSB
+#define GOLDEN_VERSION          1
+#define ADPCM_MIN_SNR_DB        20.0
+#define VAD_STEP_MAX_RELEASE_S  10.0    // Noise step to voice closed, at most
+
+struct FrameResult {
+    uint32_t meanSquareQ30;
+    uint16_t zeroCrossings;
+    bool voice;
+    int16_t nsRms;
+    int16_t agcRms;
+    uint32_t nsCrc;
+    uint32_t agcCrc;
+};
+
+struct Corpus {
+    std::string name;
+    std::vector<int16_t> samples;
+    size_t frames() const { return samples.size() / FRAME; }
+    const int16_t* frame(size_t i) const { return &samples[i * FRAME]; }
+};
+
+struct Options {
+    bool exact = false;
+    bool update = false;
+    bool synthetic = false;
+    int repeat = 20;
+    std::string goldenDir = "bench/golden";
+    std::vector<std::string> files;
+};
+
+// Defeats dead-code elimination of the pure kernels
+static volatile uint32_t benchSink;
+
+static uint32_t crc32(const void* data, size_t length) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+// Corpora
+
+static uint16_t le16(const uint8_t* p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t le32(const uint8_t* p) { return le16(p) | ((uint32_t)le16(p + 2) << 16); }
+
+static bool loadWav(const std::string& path, Corpus& corpus) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        fprintf(stderr, "%s: cannot open\n", path.c_str());
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buffer[4096];
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + got);
+    }
+    fclose(file);
+
+    if (data.size() < 12 || memcmp(&data[0], "RIFF", 4) || memcmp(&data[8], "WAVE", 4)) {
+        fprintf(stderr, "%s: not a RIFF/WAVE file\n", path.c_str());
+        return false;
+    }
+
+    bool formatOk = false;
+    for (size_t pos = 12; pos + 8 <= data.size();) {
+        uint32_t size = le32(&data[pos + 4]);
+        const uint8_t* body = &data[pos + 8];
+        if (pos + 8 + size > data.size()) {
+            size = (uint32_t)(data.size() - pos - 8);    // Truncated recording
+        }
+        if (!memcmp(&data[pos], "fmt ", 4) && size >= 16) {
+            formatOk = le16(body) == 1 && le16(body + 2) == 1 &&
+                       le32(body + 4) == AUDIO_SAMPLE_RATE && le16(body + 14) == 16;
+        } else if (!memcmp(&data[pos], "data", 4)) {
+            if (!formatOk) {
+                fprintf(stderr, "%s: need 16-bit mono PCM at %d Hz\n", path.c_str(),
+                        AUDIO_SAMPLE_RATE);
+                return false;
+            }
+            corpus.samples.resize(size / 2);
+            for (size_t i = 0; i < corpus.samples.size(); i++) {
+                corpus.samples[i] = (int16_t)le16(body + 2 * i);
+            }
+            break;
+        }
+        pos += 8 + size + (size & 1);
+    }
+
+    size_t slash = path.find_last_of("/\\");
+    corpus.name = path.substr(slash == std::string::npos ? 0 : slash + 1);
+    if (corpus.name.size() > 4 && corpus.name.compare(corpus.name.size() - 4, 4, ".wav") == 0) {
+        corpus.name.resize(corpus.name.size() - 4);
+    }
+    if (corpus.frames() == 0) {
+        fprintf(stderr, "%s: no audio frames\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Six seconds of low-level noise with two voiced passages and a louder
+// noise stretch in between. Fully deterministic.
+static Corpus syntheticCorpus() {
+    Corpus corpus;
+    corpus.name = "synthetic";
+    const size_t length = 6 * AUDIO_SAMPLE_RATE;
+    corpus.samples.resize(length);
+
+    uint32_t lcg = 12345;
+    for (size_t n = 0; n < length; n++) {
+        double t = (double)n / AUDIO_SAMPLE_RATE;
+        lcg = lcg * 1664525u + 1013904223u;
+        double noise = ((int32_t)(lcg >> 16) - 32768) / 32768.0;
+        double noiseLevel = (t >= 2.8 && t < 3.4) ? 0.02 : 0.004;
+        double sample = noise * noiseLevel;
+
+        bool voiced = (t >= 1.0 && t < 2.5) || (t >= 3.6 && t < 5.2);
+        if (voiced) {
+            // 140 Hz glottal harmonics, 4 Hz syllable envelope
+            double envelope = 0.5 - 0.5 * cos(2 * M_PI * 4 * t);
+            double voice = 0;
+            for (int h = 1; h <= 12; h++) {
+                voice += sin(2 * M_PI * 140 * h * t + h) / h;
+            }
+            sample += 0.12 * envelope * voice;
+        }
+        long q = lrint(sample * 32767);
+        corpus.samples[n] = (int16_t)(q > 32767 ? 32767 : q < -32768 ? -32768 : q);
+    }
+    return corpus;
+}
+
+// Two seconds of hiss, then fifteen of rumble 30 dB louder: a fan or
+// traffic behind the mic. Low-passed, so it crosses zero like voice.
+static Corpus noiseStepCorpus() {
+    Corpus corpus;
+    corpus.name = "noise_step";
+    const size_t step = 2 * AUDIO_SAMPLE_RATE;
+    const size_t length = step + 15 * AUDIO_SAMPLE_RATE;
+    corpus.samples.resize(length);
+
+    uint32_t lcg = 777;
+    double pole = 0, rumble = 0;
+    for (size_t n = 0; n < length; n++) {
+        lcg = lcg * 1664525u + 1013904223u;
+        double noise = ((int32_t)(lcg >> 16) - 32768) / 32768.0;
+        pole += 0.05 * (noise - pole);          // Two poles at ~130 Hz
+        rumble += 0.05 * (pole - rumble);
+        double sample = n < step ? 0.004 * noise : 2.0 * rumble;
+        corpus.samples[n] = (int16_t)lrint(sample * 32767);
+    }
+    return corpus;
+}
+
+// Seconds from the step until the VAD is closed for good, negative if it
+// is still open at the end
+static double vadStepReleaseSeconds() {
+    Corpus corpus = noiseStepCorpus();
+    static Vad vad;
+    vadInit(vad, vadConfig);
+    size_t stepFrame = 2 * AUDIO_SAMPLE_RATE / FRAME;
+    size_t lastVoice = 0;
+    bool opened = false;
+    for (size_t i = 0; i < corpus.frames(); i++) {
+        if (vadProcess(vad, corpus.frame(i), FRAME)) {
+            lastVoice = i;
+            opened |= i >= stepFrame;
+        }
+    }
+    if (lastVoice + 1 == corpus.frames()) {
+        return -1;
+    }
+    if (!opened) {
+        return 0;       // Never mistaken for voice in the first place
+    }
+    return (double)(lastVoice + 1 - stepFrame) * FRAME / AUDIO_SAMPLE_RATE;
+}
+
+// Kernels
+
+// The firmware chain: VAD -> NR (learns while the VAD is closed) -> AGC
+static void runChain(const Corpus& corpus, std::vector<FrameResult>& results) {
+    static Vad vad;
+    static NoiseSuppressor ns;
+    static Agc agc;
+    vadInit(vad, vadConfig);
+    nsInit(ns, nsConfig);
+    nsSetLevel(ns, (uint8_t)(NOISE_REDUCTION_LEVEL * 100));
+    agcInit(agc, agcConfig);
+
+    results.resize(corpus.frames());
+    int16_t frame[FRAME];
+    for (size_t i = 0; i < corpus.frames(); i++) {
+        FrameResult& r = results[i];
+        DspFrameStats stats = dspFrameStats(corpus.frame(i), FRAME);
+        r.meanSquareQ30 = stats.meanSquareQ30;
+        r.zeroCrossings = stats.zeroCrossings;
+        r.voice = vadProcess(vad, corpus.frame(i), FRAME);
+
+        nsProcess(ns, corpus.frame(i), frame, r.voice);
+        r.nsRms = dspRmsQ15(frame, FRAME);
+        r.nsCrc = crc32(frame, sizeof(frame));
+
+        agcProcess(agc, frame, FRAME, r.voice);
+        r.agcRms = dspRmsQ15(frame, FRAME);
+        r.agcCrc = crc32(frame, sizeof(frame));
+    }
+}
+
+typedef void (*KernelPass)(const Corpus& corpus, const std::vector<FrameResult>& ref);
+
+static void passEnergy(const Corpus& corpus, const std::vector<FrameResult>&) {
+    for (size_t i = 0; i < corpus.frames(); i++) {
+        benchSink = dspMeanSquareQ30(corpus.frame(i), FRAME);
+    }
+}
+
+static void passFrameStats(const Corpus& corpus, const std::vector<FrameResult>&) {
+    for (size_t i = 0; i < corpus.frames(); i++) {
+        benchSink = dspFrameStats(corpus.frame(i), FRAME).meanSquareQ30;
+    }
+}
+
+static void passVad(const Corpus& corpus, const std::vector<FrameResult>&) {
+    static Vad vad;
+    vadInit(vad, vadConfig);
+    for (size_t i = 0; i < corpus.frames(); i++) {
+        benchSink = vadProcess(vad, corpus.frame(i), FRAME);
+    }
+}
+
+static void passFft(const Corpus& corpus, const std::vector<FrameResult>&) {
+    static int32_t input[DSP_FFT_SIZE];
+    static DspComplex spectrum[DSP_FFT_BINS];
+    for (size_t i = 0; i + 2 <= corpus.frames(); i += 2) {
+        // Two frames plus zero padding, as the suppressor sees them
+        for (size_t n = 0; n < DSP_FFT_SIZE; n++) {
+            input[n] = n < 2 * FRAME ? corpus.frame(i)[n] : 0;
+        }
+        dspRealFft(input, spectrum);
+        benchSink = (uint32_t)spectrum[1].re;
+    }
+}
+
+static void passNoise(const Corpus& corpus, const std::vector<FrameResult>& ref) {
+    static NoiseSuppressor ns;
+    nsInit(ns, nsConfig);
+    nsSetLevel(ns, (uint8_t)(NOISE_REDUCTION_LEVEL * 100));
+    int16_t frame[FRAME];
+    for (size_t i = 0; i < corpus.frames(); i++) {
+        nsProcess(ns, corpus.frame(i), frame, ref[i].voice);
+        benchSink = (uint32_t)frame[0];
+    }
+}
+
+static void passAgc(const Corpus& corpus, const std::vector<FrameResult>& ref) {
+    static Agc agc;
+    agcInit(agc, agcConfig);
+    int16_t frame[FRAME];
+    for (size_t i = 0; i < corpus.frames(); i++) {
+        memcpy(frame, corpus.frame(i), sizeof(frame));
+        agcProcess(agc, frame, FRAME, ref[i].voice);
+        benchSink = (uint32_t)frame[0];
+    }
+}
+
+static void passAdpcm(const Corpus& corpus, const std::vector<FrameResult>&) {
+    AdpcmState state;
+    adpcmReset(state);
+    uint8_t packed[FRAME / 2];
+    for (size_t i = 0; i < corpus.frames(); i++) {
+        adpcmEncode(state, corpus.frame(i), FRAME, packed);
+        benchSink = packed[0];
+    }
+}
+
+// Signal to round-trip error ratio over the whole corpus
+static double adpcmSnrDb(const Corpus& corpus) {
+    AdpcmState encoder, decoder;
+    adpcmReset(encoder);
+    adpcmReset(decoder);
+    uint8_t packed[FRAME / 2];
+    int16_t decoded[FRAME];
+    double signal = 0, noise = 0;
+    for (size_t i = 0; i < corpus.frames(); i++) {
+        const int16_t* frame = corpus.frame(i);
+        adpcmEncode(encoder, frame, FRAME, packed);
+        adpcmDecode(decoder, packed, sizeof(packed), decoded);
+        for (size_t n = 0; n < FRAME; n++) {
+            double error = (double)frame[n] - decoded[n];
+            signal += (double)frame[n] * frame[n];
+            noise += error * error;
+        }
+    }
+    return noise > 0 ? 10.0 * log10(signal / noise) : 99.0;
+}
+
+struct Kernel {
+    const char* name;
+    KernelPass pass;
+};
+
+static const Kernel kernels[] = {
+    { "energy",      passEnergy },
+    { "frame_stats", passFrameStats },
+    { "vad",         passVad },
+    { "fft512",      passFft },
+    { "noise",       passNoise },
+    { "agc",         passAgc },
+    { "adpcm",       passAdpcm },
+};
+
+// Fastest of `repeat` passes, in ns per frame of audio
+static double timeKernel(const Kernel& kernel, const Corpus& corpus,
+                         const std::vector<FrameResult>& ref, int repeat) {
+    double best = 1e300;
+    for (int r = 0; r < repeat; r++) {
+        auto start = std::chrono::steady_clock::now();
+        kernel.pass(corpus, ref);
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        if (ns < best) {
+            best = ns;
+        }
+    }
+    return best / corpus.frames();
+}
+
+// Golden files: a header line, then one line per frame:
+//   meanSquareQ30 zeroCrossings voice nsRms agcRms nsCrc agcCrc
+
+static std::string goldenPath(const Options& options, const Corpus& corpus) {
+    return options.goldenDir + "/" + corpus.name + ".golden";
+}
+
+static bool writeGolden(const std::string& path, const std::vector<FrameResult>& results) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        fprintf(stderr, "%s: cannot write\n", path.c_str());
+        return false;
+    }
+    fprintf(file, "dsp-golden %d frames %zu\n", GOLDEN_VERSION, results.size());
+    for (const FrameResult& r : results) {
+        fprintf(file, "%u %u %d %d %d %08x %08x\n", r.meanSquareQ30, r.zeroCrossings,
+                r.voice ? 1 : 0, r.nsRms, r.agcRms, r.nsCrc, r.agcCrc);
+    }
+    fclose(file);
+    return true;
+}
+
+static bool readGolden(const std::string& path, std::vector<FrameResult>& golden) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (!file) {
+        return false;
+    }
+    int version = 0;
+    size_t frames = 0;
+    if (fscanf(file, "dsp-golden %d frames %zu", &version, &frames) != 2 ||
+        version != GOLDEN_VERSION) {
+        fclose(file);
+        fprintf(stderr, "%s: unknown golden format\n", path.c_str());
+        return false;
+    }
+    golden.resize(frames);
+    for (FrameResult& r : golden) {
+        unsigned zcr;
+        int voice, nsRms, agcRms;
+        if (fscanf(file, "%u %u %d %d %d %x %x", &r.meanSquareQ30, &zcr, &voice,
+                   &nsRms, &agcRms, &r.nsCrc, &r.agcCrc) != 7) {
+            fclose(file);
+            fprintf(stderr, "%s: truncated\n", path.c_str());
+            return false;
+        }
+        r.zeroCrossings = (uint16_t)zcr;
+        r.voice = voice != 0;
+        r.nsRms = (int16_t)nsRms;
+        r.agcRms = (int16_t)agcRms;
+    }
+    fclose(file);
+    return true;
+}
+
+static bool energyClose(uint32_t actual, uint32_t expected, bool exact) {
+    uint64_t diff = actual > expected ? actual - expected : expected - actual;
+    return exact ? diff == 0 : diff <= 1 + (uint64_t)expected * GOLDEN_ENERGY_PPM / 1000000;
+}
+
+static bool rmsClose(int16_t actual, int16_t expected) {
+    int tolerance = abs(expected) / 100;
+    if (tolerance < GOLDEN_RMS_TOLERANCE) {
+        tolerance = GOLDEN_RMS_TOLERANCE;
+    }
+    return abs(actual - expected) <= tolerance;
+}
+
+// Returns the number of frames that differ; prints the first few
+static size_t compareGolden(const std::vector<FrameResult>& actual,
+                            const std::vector<FrameResult>& golden, bool exact) {
+    if (actual.size() != golden.size()) {
+        printf("  frame count %zu, golden has %zu\n", actual.size(), golden.size());
+        return actual.size() > golden.size() ? actual.size() : golden.size();
+    }
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < actual.size(); i++) {
+        const FrameResult& a = actual[i];
+        const FrameResult& g = golden[i];
+        const char* what = nullptr;
+        if (a.voice != g.voice) {
+            what = "VAD decision";
+        } else if (a.zeroCrossings != g.zeroCrossings) {
+            what = "zero-crossing count";
+        } else if (!energyClose(a.meanSquareQ30, g.meanSquareQ30, exact)) {
+            what = "frame energy";
+        } else if (!rmsClose(a.nsRms, g.nsRms)) {
+            what = "NR output level";
+        } else if (!rmsClose(a.agcRms, g.agcRms)) {
+            what = "AGC output level";
+        } else if (exact && (a.nsCrc != g.nsCrc || a.agcCrc != g.agcCrc)) {
+            what = "output samples";
+        }
+        if (what && ++mismatches <= 5) {
+            printf("  frame %zu (%.2f s): %s differs\n", i,
+                   (double)i * FRAME / AUDIO_SAMPLE_RATE, what);
+        }
+    }
+    return mismatches;
+}
+
+static bool runCorpus(const Corpus& corpus, const Options& options) {
+    double seconds = (double)corpus.samples.size() / AUDIO_SAMPLE_RATE;
+    printf("\n%s: %zu frames (%.1f s)\n", corpus.name.c_str(), corpus.frames(), seconds);
+
+    std::vector<FrameResult> results;
+    runChain(corpus, results);
+
+    size_t voiced = 0;
+    for (const FrameResult& r : results) {
+        voiced += r.voice;
+    }
+    printf("  VAD active in %zu frames (%.0f %%)\n", voiced, 100.0 * voiced / results.size());
+
+    double snr = adpcmSnrDb(corpus);
+    printf("  ADPCM round trip SNR %.1f dB\n", snr);
+    bool adpcmOk = snr >= ADPCM_MIN_SNR_DB;
+    if (!adpcmOk) {
+        printf("  ADPCM SNR below %.0f dB\n", ADPCM_MIN_SNR_DB);
+    }
+
+    printf("  %-12s %10s %12s\n", "kernel", "ns/frame", "x realtime");
+    double frameNs = 1e9 * FRAME / AUDIO_SAMPLE_RATE;
+    for (const Kernel& kernel : kernels) {
+        double ns = timeKernel(kernel, corpus, results, options.repeat);
+        printf("  %-12s %10.1f %12.0f\n", kernel.name, ns, ns > 0 ? frameNs / ns : 0);
+    }
+
+    std::string path = goldenPath(options, corpus);
+    if (options.update) {
+        bool ok = writeGolden(path, results) && adpcmOk;
+        if (ok) {
+            printf("  golden written: %s\n", path.c_str());
+        }
+        return ok;
+    }
+
+    std::vector<FrameResult> golden;
+    if (!readGolden(path, golden)) {
+        printf("  golden MISSING: %s (run with --update)\n", path.c_str());
+        return false;
+    }
+    size_t mismatches = compareGolden(results, golden, options.exact);
+    if (mismatches) {
+        printf("  golden MISMATCH: %zu frames differ from %s\n", mismatches, path.c_str());
+        return false;
+    }
+    printf("  golden OK (%s)\n", options.exact ? "bit-exact" : "within tolerance");
+    return adpcmOk;
+}
+
+static bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--exact") {
+            options.exact = true;
+        } else if (arg == "--update") {
+            options.update = true;
+        } else if (arg == "--synthetic") {
+            options.synthetic = true;
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            options.repeat = atoi(argv[++i]);
+        } else if (arg == "--golden" && i + 1 < argc) {
+            options.goldenDir = argv[++i];
+        } else if (arg.size() > 2 && arg.compare(0, 2, "--") == 0) {
+            fprintf(stderr, "unknown option %s\n", arg.c_str());
+            return false;
+        } else {
+            options.files.push_back(arg);
+        }
+    }
+    if (options.files.empty()) {
+        options.synthetic = true;
+    }
+    if (options.repeat < 1) {
+        options.repeat = 1;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 2;
+    }
+
+    printf("DSP bench: %d Hz, %d-sample frames, %s path\n", AUDIO_SAMPLE_RATE, FRAME,
+           DSP_FIXED_POINT ? "fixed-point" : "float reference");
+
+    bool ok = true;
+    double release = vadStepReleaseSeconds();
+    if (release < 0 || release > VAD_STEP_MAX_RELEASE_S) {
+        printf("\nVAD noise step: still open %s after the step (limit %.0f s)\n",
+               release < 0 ? "at the end, 15 s" : "too long", VAD_STEP_MAX_RELEASE_S);
+        ok = false;
+    } else {
+        printf("\nVAD noise step: closed %.2f s after the step\n", release);
+    }
+
+    if (options.synthetic) {
+        ok &= runCorpus(syntheticCorpus(), options);
+    }
+    for (const std::string& path : options.files) {
+        Corpus corpus;
+        if (!loadWav(path, corpus)) {
+            ok = false;
+            continue;
+        }
+        ok &= runCorpus(corpus, options);
+    }
+    return ok ? 0 : 1;
+}
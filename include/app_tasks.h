@@ -0,0 +1,77 @@
+/**
+ * FreeRTOS Task Layout for ESP32-C3 SuperMini Bluetooth Headset
+ *
+ * Each subsystem runs in its own task at a fixed priority so a slow display
+ * flush or BLE notify can no longer delay audio or button handling:
+ *
+ *   audio      TASK_PRIORITY_HIGH    blocks on the I2S DMA event queue
+ *   control    TASK_PRIORITY_NORMAL  buttons and remote commands
+ *   display    TASK_PRIORITY_LOW     OLED redraws, on DisplayEvents only
+ *   telemetry  TASK_PRIORITY_LOW     battery, charger and BLE status
+ *
+ * Tasks exchange work only through the queues below. The task bodies are
+ * implemented by the application (main.cpp).
+ */
+
+#ifndef APP_TASKS_H
+#define APP_TASKS_H
+
+#include <Arduino.h>
+
+// Button identifiers, in the order they are scanned
+enum ButtonId : uint8_t {
+    BUTTON_PWR = 0,
+    BUTTON_VOL_UP,
+    BUTTON_VOL_DN,
+    BUTTON_MUTE,
+    BUTTON_COUNT
+};
+
+// Work items for the control task
+enum ControlEventType : uint8_t {
+    CONTROL_BUTTON = 0,         // id = ButtonId, value = ButtonAction
+    CONTROL_SET_VOLUME,         // value = 0-15
+    CONTROL_SET_MUTE,           // id = 0 off, 1 on, 2 toggle
+    CONTROL_SET_POWER,          // id = 0 off, 1 on
+    CONTROL_SET_VAD_THRESHOLD,  // value = RMS threshold, Q15
+    CONTROL_SET_NR_LEVEL,       // value = 0-100 %
+    CONTROL_POWER_STATE,        // id = PowerState the sequencer entered
+    CONTROL_CHARGE_STATE,       // id = ChargeState after a transition
+};
+
+struct ControlEvent {
+    uint8_t type;           // ControlEventType
+    uint8_t id;
+    uint16_t value;
+};
+
+// Reasons for the display task to redraw
+enum DisplayEvent : uint8_t {
+    DISPLAY_REFRESH = 0,
+    DISPLAY_SLEEP,              // Panel off, rendering suspended
+    DISPLAY_WAKE,               // Panel on, full redraw
+    DISPLAY_SHUTDOWN,           // Panel off before deep sleep or restart; notifies the poster
+};
+
+extern QueueHandle_t controlQueue;
+extern QueueHandle_t displayQueue;
+extern TaskHandle_t audioTaskHandle;
+
+// Task periods from config.h, in ticks
+extern const TickType_t telemetryPeriodTicks;   // TELEMETRY_INTERVAL_MS
+
+// Task bodies (application)
+void audioTask(void* param);
+void controlTask(void* param);
+void displayTask(void* param);
+void telemetryTask(void* param);
+
+// Create the queues and start all tasks. Returns false if any allocation
+// failed; tasks that were created keep running.
+bool appTasksStart();
+
+// Non-blocking helpers; return false when the queue is full
+bool postControlEvent(uint8_t type, uint8_t id, uint16_t value = 0);
+bool postDisplayEvent(DisplayEvent event = DISPLAY_REFRESH);
+
+#endif // APP_TASKS_H
@@ -0,0 +1,33 @@
+/**
+ * I2S Microphone Capture for ESP32-C3 SuperMini Bluetooth Headset
+ *
+ * Drives the I2S peripheral in master RX mode with two DMA descriptors of
+ * exactly one audio frame each. The driver raises one RX_DONE event per
+ * completed descriptor, so the consumer only wakes once per 10ms frame and
+ * reads the finished frame straight into the buffer the pipeline works on.
+ */
+
+#ifndef AUDIO_CAPTURE_H
+#define AUDIO_CAPTURE_H
+
+#include <Arduino.h>
+
+// Install the I2S driver and route the microphone pins. Capture stays
+// stopped until audioCaptureSetEnabled(true) is called.
+bool audioCaptureBegin();
+
+// Start or stop the I2S clocks (stopping also idles the MEMS mic)
+void audioCaptureSetEnabled(bool enabled);
+bool audioCaptureEnabled();
+
+// Wait up to `timeout` ticks for the next completed DMA frame and copy its
+// audioCaptureFrameSize() samples into `frame`. Returns false on timeout.
+// The wait is on the driver's ISR event queue, so a portMAX_DELAY caller
+// sleeps while capture is stopped.
+bool audioCaptureRead(int16_t* frame, TickType_t timeout);
+
+// Samples per frame and frames lost because the consumer fell behind
+size_t audioCaptureFrameSize();
+uint32_t audioCaptureOverruns();
+
+#endif // AUDIO_CAPTURE_H
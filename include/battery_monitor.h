@@ -0,0 +1,31 @@
+/**
+ * Battery Measurement
+ *
+ * Every BAT_CHECK_INTERVAL_MS the battery divider is read in one burst of
+ * BAT_SAMPLES one-shot ADC conversions. The averaged raw value is converted
+ * to millivolts with the chip's eFuse calibration (esp_adc_cal). Readings
+ * then go through an integer IIR low-pass. The state of charge comes from
+ * a Li-ion open-circuit-voltage table with linear interpolation between
+ * points. Nothing is sampled between intervals.
+ */
+
+#ifndef BATTERY_MONITOR_H
+#define BATTERY_MONITOR_H
+
+#include <Arduino.h>
+
+// Configure the ADC channel behind `adcPin` and take a first reading
+bool batteryMonitorBegin(uint8_t adcPin);
+
+// Sample if the check interval has elapsed. Returns true when a new reading
+// was taken. Cheap to call more often.
+bool batteryMonitorUpdate();
+
+uint16_t batteryMonitorMillivolts();    // Filtered battery voltage
+uint8_t batteryMonitorPercent();        // 0-100, from the discharge curve
+
+// True if the chip has a factory ADC calibration in eFuse (otherwise the
+// ADC_VREF default is used)
+bool batteryMonitorCalibrated();
+
+#endif // BATTERY_MONITOR_H
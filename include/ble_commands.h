@@ -0,0 +1,50 @@
+/**
+ * Binary BLE Command Protocol
+ *
+ * Host writes to the control characteristic carry one or more TLV records
+ * back to back, so a companion app can batch several settings in a single
+ * write:
+ *
+ *   [opcode u8][length u8][value: length bytes] [opcode][length][value] ...
+ *
+ *   opcode  name            value
+ *   0x01    VOLUME_SET      u8  0-15
+ *   0x02    MUTE            u8  0 = off, 1 = on, 2 = toggle
+ *   0x03    POWER           u8  0 = off, 1 = on
+ *   0x04    VAD_THRESHOLD   u16 RMS threshold, Q15 (little endian)
+ *   0x05    NR_LEVEL        u8  noise reduction strength, 0-100 %
+ *   0x06    DISPLAY         u8  0 = off, 1 = on
+ *
+ * Records are validated and dispatched through a handler table from the
+ * BLE stack's write callback. Handlers never block: each one only queues
+ * the work to the task that owns it. Parsing stops at the first malformed
+ * record; records before it have already been applied.
+ */
+
+#ifndef BLE_COMMANDS_H
+#define BLE_COMMANDS_H
+
+#include <Arduino.h>
+#include <BLECharacteristic.h>
+
+enum BleOpcode : uint8_t {
+    BLE_OP_VOLUME_SET    = 0x01,
+    BLE_OP_MUTE          = 0x02,
+    BLE_OP_POWER         = 0x03,
+    BLE_OP_VAD_THRESHOLD = 0x04,
+    BLE_OP_NR_LEVEL      = 0x05,
+    BLE_OP_DISPLAY       = 0x06,
+};
+
+#define BLE_MUTE_TOGGLE         2
+
+// Attach the write callback to the control characteristic
+void bleCommandsBegin(BLECharacteristic* characteristic);
+
+// Parse and dispatch one write. Returns the number of records applied.
+size_t bleCommandsDispatch(const uint8_t* data, size_t length);
+
+// Records rejected (unknown opcode, bad length or value, queue full)
+uint32_t bleCommandErrors();
+
+#endif // BLE_COMMANDS_H
@@ -0,0 +1,35 @@
+/**
+ * BLE HID-over-GATT Keyboard, Media Keys and Battery Service
+ *
+ * Standard HID service next to the custom headset service, so a paired
+ * host sees the headset as a keyboard/consumer control device and handles
+ * the conferencing shortcuts and media keys without a companion app. Uses
+ * the report map from hid_keys.h. The Battery Service (0x180F) carries the
+ * battery level and notifies only when the percentage changes.
+ *
+ * HID characteristics need an encrypted link; pairing is "just works" with
+ * bonding, the custom service stays open.
+ */
+
+#ifndef BLE_HID_H
+#define BLE_HID_H
+
+#include "hid_keys.h"
+#include <BLEServer.h>
+
+// Add the HID and battery services to the server and the HID UUID and
+// appearance to the advertising data. Call from initBLE() before
+// advertising starts.
+bool bleHidBegin(BLEServer* server);
+
+// A host is connected and has enabled keyboard input notifications
+bool bleHidReady();
+
+// Notify one input report (HID_REPORT_ID_*); false if the host has not
+// subscribed to it
+bool bleHidSendReport(uint8_t reportId, const void* data, uint8_t length);
+
+// Battery level characteristic (0x2A19); notifies on change only
+void bleHidSetBattery(uint8_t percent, bool connected);
+
+#endif // BLE_HID_H
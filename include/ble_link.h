@@ -0,0 +1,80 @@
+/**
+ * BLE Connection Manager
+ *
+ * Owns advertising and the connection parameters. While connected the link
+ * runs one of two profiles:
+ *
+ *   idle    BT_IDLE_INTERVAL_*, slave latency BT_IDLE_LATENCY, 1M PHY
+ *   active  BT_ACTIVE_INTERVAL_*, no latency, 2M PHY where the peer has it
+ *
+ * A new connection starts active (discovery, bonding) and drops to idle
+ * after BT_ACTIVE_HOLD_MS without traffic. Control writes, diagnostics reads
+ * and streaming switch it back to active at once. The local ATT MTU is
+ * BT_LINK_MTU; the peer's exchange request settles the final value.
+ *
+ * Advertising: fast for BT_PAIRING_TIMEOUT_MS after boot. After a
+ * disconnect, up to BT_RECONNECT_ATTEMPTS windows of fast advertising
+ * (BT_RECONNECT_WINDOW_MS each) separated by quiet gaps that start at
+ * BT_RECONNECT_DELAY_MS and double per attempt. When the attempts or the
+ * pairing window run out, it stays discoverable at BT_ADV_SLOW_INTERVAL_MS.
+ */
+
+#ifndef BLE_LINK_H
+#define BLE_LINK_H
+
+#include <Arduino.h>
+#include <BLEServer.h>
+
+enum BleLinkState : uint8_t {
+    BLE_LINK_PAIRING = 0,       // Fast advertising after boot
+    BLE_LINK_RECONNECTING,      // Fast advertising, one reconnection attempt
+    BLE_LINK_BACKOFF,           // Radio quiet until the next attempt
+    BLE_LINK_DISCOVERABLE,      // Slow advertising, no deadline
+    BLE_LINK_CONNECTED
+};
+
+enum BleLinkProfile : uint8_t {
+    BLE_LINK_PROFILE_IDLE = 0,
+    BLE_LINK_PROFILE_ACTIVE
+};
+
+// Users that keep the link active for a bulk transfer, one bit each
+enum BleLinkHolder : uint8_t {
+    BLE_LINK_HOLD_MIC_STREAM = 0x01,
+    BLE_LINK_HOLD_OTA = 0x02
+};
+
+// Set the local MTU and start advertising. Call at the end of initBLE().
+void bleLinkBegin(BLEServer* server);
+
+// Server callbacks (BLE stack task)
+void bleLinkConnected(esp_ble_gatts_cb_param_t* param);
+void bleLinkDisconnected();
+
+// Host traffic on the link; requests the active profile. Any task.
+void bleLinkActivity();
+
+// Keep the active profile while any holder holds it, e.g. during streaming
+void bleLinkHoldActive(BleLinkHolder holder, bool held);
+
+// Advertising deadlines and the return to idle; call periodically
+void bleLinkService();
+
+BleLinkState bleLinkState();
+BleLinkProfile bleLinkProfile();
+
+// Connected and encrypted with keys from a bonded pairing
+bool bleLinkSecure();
+
+// ATT MTU of the current connection (23 until the peer exchanged one)
+uint16_t bleLinkMtu();
+
+// Ask the controller for the link RSSI; the answer arrives asynchronously
+void bleLinkRequestRssi();
+
+// Last RSSI reading in dBm, BLE_LINK_RSSI_NONE while disconnected or
+// before the first answer
+#define BLE_LINK_RSSI_NONE      INT8_MIN
+int8_t bleLinkRssi();
+
+#endif // BLE_LINK_H
@@ -0,0 +1,94 @@
+/**
+ * Firmware Update over BLE
+ *
+ * Streams an application image into the inactive OTA partition
+ * (min_spiffs.csv: two app slots) while it arrives; the image is never
+ * buffered whole. Its own GATT service, OTA_SERVICE_UUID, with two
+ * characteristics:
+ *
+ *   control  write, notify     commands and status
+ *   data     write no response [offset u32][image bytes ...]
+ *
+ * Commands (control writes):
+ *
+ *   [OTA_CMD_BEGIN][size u32][sha256 32 bytes][signature 64 bytes]
+ *       Start an update, or resume the running one if size and digest
+ *       match (after a disconnect, before a reboot). The signature is
+ *       ECDSA P-256 over the SHA-256 of the image, raw r || s, made with
+ *       the private half of OTA_SIGNING_PUBLIC_KEY.
+ *   [OTA_CMD_ABORT]
+ *
+ * Status (control notifications), each followed by an offset u32:
+ *
+ *   OTA_STATUS_READY   bytes already committed, then [window u8]
+ *                      [chunkMax u16]. Send from that offset on.
+ *   OTA_STATUS_ACK     committed so far
+ *   OTA_STATUS_RESYNC  a chunk was missing or did not fit; resend from
+ *                      the offset
+ *   OTA_STATUS_DONE    verified and selected for boot; restarting
+ *   OTA_STATUS_ERROR   then [OtaError u8]; the session is over
+ *
+ * Flow: the host keeps at most `window` data chunks of up to `chunkMax`
+ * bytes unacknowledged. An ACK goes out after every OTA_ACK_CHUNKS
+ * committed chunks, so a half window is always in flight. The BLE stack
+ * task only copies chunks into an SPSC ring (spsc_ring.h). The OTA task
+ * writes them to flash (sectors are erased as the write reaches them) and
+ * feeds the SHA-256. The last byte triggers the digest check and
+ * esp_ota_end(), which validates the image. Only then is the new
+ * partition selected for boot and the chip restarted.
+ *
+ * A session with no data for OTA_SESSION_TIMEOUT_MS is aborted.
+ *
+ * Both characteristics need an encrypted link, and commands and chunks are
+ * dropped unless the host is bonded (bleLinkSecure()). A new session only
+ * starts once the signature checks out, so an image built without the
+ * release key is never written.
+ */
+
+#ifndef BLE_OTA_H
+#define BLE_OTA_H
+
+#include <Arduino.h>
+
+class BLEServer;
+
+#define OTA_CMD_BEGIN           0x01
+#define OTA_CMD_ABORT           0x02
+
+#define OTA_STATUS_READY        0x00
+#define OTA_STATUS_ACK          0x01
+#define OTA_STATUS_RESYNC       0x02
+#define OTA_STATUS_DONE         0x03
+#define OTA_STATUS_ERROR        0x04
+
+enum OtaError : uint8_t {
+    OTA_ERR_NONE = 0,
+    OTA_ERR_NO_PARTITION,       // No inactive app slot in the partition table
+    OTA_ERR_SIZE,               // Image larger than the slot
+    OTA_ERR_FLASH,              // Erase or write failed
+    OTA_ERR_DIGEST,             // SHA-256 mismatch
+    OTA_ERR_IMAGE,              // esp_ota_end() rejected the image
+    OTA_ERR_TIMEOUT,
+    OTA_ERR_ABORTED,
+    OTA_ERR_SIGNATURE           // Digest not signed with the release key
+};
+
+struct BleOtaStats {
+    uint32_t imageSize;         // 0 while no session is open
+    uint32_t committed;         // Bytes written and hashed
+    uint32_t chunksDropped;     // Ring full: the host overran its window
+    uint32_t resyncs;
+};
+
+// Called from the OTA task right before the restart into the new image
+typedef void (*OtaRestartCallback)();
+
+// Create the OTA service on `server` and start the OTA task
+bool bleOtaBegin(BLEServer* server, OtaRestartCallback beforeRestart);
+
+// True while an update session is open
+bool bleOtaActive();
+
+BleOtaStats bleOtaStats();
+
+#endif // BLE_OTA_H
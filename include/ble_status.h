@@ -0,0 +1,70 @@
+/**
+ * Event-Driven BLE Status Notifications
+ *
+ * The status characteristic carries a small packed binary record that is
+ * only notified when a field actually changes. Changes arriving faster than
+ * BT_STATUS_MIN_INTERVAL_MS are coalesced into one notification carrying the
+ * latest values. The coalesced notification has no timer of its own: it goes
+ * out on the next bleStatusUpdate() or telemetry tick (bleStatusService(),
+ * every TELEMETRY_INTERVAL_MS) after the window closes, so a burst's last
+ * change can lag by up to that period.
+ *
+ * Setting BT_STATUS_TEXT_COMPAT in config.h restores the old
+ * "volume,muted,battery" text payload for existing clients.
+ *
+ * The binary record no longer carries the battery level: hosts read it from
+ * the standard Battery Service (ble_hid.h), so a battery step does not
+ * cost a status notification.
+ */
+
+#ifndef BLE_STATUS_H
+#define BLE_STATUS_H
+
+#include <Arduino.h>
+#include <BLECharacteristic.h>
+
+#define BLE_STATUS_VERSION      2   // 2: battery moved to the Battery Service
+
+// Status flag bits
+#define BLE_STATUS_MUTED        0x01
+#define BLE_STATUS_VOICE        0x02
+#define BLE_STATUS_CHARGING     0x04
+#define BLE_STATUS_CHARGED      0x08
+#define BLE_STATUS_AUDIO_ON     0x10
+#define BLE_STATUS_POWER_FAULT  0x20    // Last audio power-up did not complete
+#define BLE_STATUS_LOW_MEMORY   0x40    // Heap below minimum or fragmented
+
+// Wire format of a status notification (little endian)
+struct __attribute__((packed)) BleStatusPacket {
+    uint8_t version;        // BLE_STATUS_VERSION
+    uint8_t sequence;       // Increments per notification, for loss detection
+    uint8_t volume;
+    uint8_t flags;          // BLE_STATUS_* bits
+};
+
+struct BleStatus {
+    uint8_t volume;
+    uint8_t flags;
+    uint8_t batteryPercent;     // Text-compat payload only
+};
+
+// Bind to the status characteristic
+void bleStatusBegin(BLECharacteristic* characteristic);
+
+// Record the current status. Notifies immediately if it changed and the rate
+// limit allows, otherwise leaves it pending for bleStatusService().
+void bleStatusUpdate(const BleStatus& status, bool connected);
+
+// Flush a pending coalesced notification once the rate limit has passed
+// (telemetry task, every TELEMETRY_INTERVAL_MS)
+void bleStatusService(bool connected);
+
+// A new client should get the full status straight away
+void bleStatusResend();
+
+// Text-compat mode only: the legacy MUTE_ON/MUTE_OFF notification
+void bleStatusNotifyMute(bool muted, bool connected);
+
+uint32_t bleStatusNotifyCount();
+
+#endif // BLE_STATUS_H
@@ -0,0 +1,57 @@
+/**
+ * Boot Timing
+ *
+ * bootMark() stamps each startup step with esp_timer_get_time(), in
+ * microseconds since the application started. Two milestones are tracked
+ * across releases:
+ *
+ *   BOOT_ADVERTISING     the headset can be found and connected to
+ *   BOOT_BUTTONS_READY   button presses are handled
+ *
+ * The table goes to the log once, on the first BLE connection of a boot.
+ * It can also be read at any time from a read-only characteristic:
+ *
+ *   [version u8][stepCount u8] stepCount x [micros u32]
+ *
+ * Steps are in BootStep order. 0 means the step was not reached, e.g. the
+ * splash on a wake from deep sleep. Fields are little endian.
+ */
+
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <Arduino.h>
+
+class BLEService;
+
+#define BOOT_PROFILE_VERSION    1
+
+// In the order setup() reaches them; BOOT_SPLASH completes asynchronously
+enum BootStep : uint8_t {
+    BOOT_LOG = 0,           // Console and deferred log
+    BOOT_SETTINGS,          // Power manager, NVS settings, pins
+    BOOT_BLE,               // BLE stack and services
+    BOOT_ADVERTISING,
+    BOOT_BATTERY,           // Battery ADC and charger
+    BOOT_CODEC_LINK,        // QCC UART and link task
+    BOOT_MIC,               // Mic pipeline and I2S capture
+    BOOT_TASKS,             // Power sequencer and application tasks
+    BOOT_BUTTONS_READY,
+    BOOT_SETUP_DONE,
+    BOOT_SPLASH,            // Display task: panel up, splash drawn
+    BOOT_STEP_COUNT
+};
+
+// Record `step` (any task); only the first mark of a step counts
+void bootMark(BootStep step);
+
+// Microseconds at `step`, 0 if not reached yet
+uint32_t bootStepMicros(BootStep step);
+
+// Add the read-only boot timing characteristic to `service`
+void bootProfileBleBegin(BLEService* service);
+
+// Log the table; does nothing after the first call (BLE stack task)
+void bootProfileReport();
+
+#endif // BOOT_PROFILE_H
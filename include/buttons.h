@@ -0,0 +1,54 @@
+/**
+ * Interrupt-Driven Button Engine
+ *
+ * Every button edge raises a GPIO interrupt that only notifies the button
+ * task. The task runs a per-button debounce and gesture state machine and
+ * sleeps until the next edge or timing deadline, so nothing polls while the
+ * buttons are idle. Recognized gestures are posted to controlQueue as
+ * CONTROL_BUTTON events (id = ButtonId, value = ButtonAction).
+ *
+ * The mute button is debounced on the leading edge: its press is accepted
+ * on the first interrupt and the settle window only filters the bounces
+ * that follow, so the host shortcut can go out within the interrupt latency
+ * instead of BUTTON_DEBOUNCE_MS later.
+ *
+ * With POWER_WAKE_ON_BUTTON in a POWER_LIGHT_SLEEP build the interrupts are
+ * level-triggered and re-armed for the opposite level on each change, so a
+ * press also wakes the chip from light sleep. Otherwise they fire on both
+ * edges.
+ *
+ * Timing comes from config.h: BUTTON_DEBOUNCE_MS, BUTTON_LONG_PRESS_MS,
+ * BUTTON_DOUBLE_CLICK_MS, BUTTON_REPEAT_DELAY_MS, BUTTON_REPEAT_MS and
+ * BUTTON_COMBO_TIMEOUT_MS.
+ */
+
+#ifndef BUTTONS_H
+#define BUTTONS_H
+
+#include <Arduino.h>
+
+enum ButtonAction : uint8_t {
+    BUTTON_PRESS = 0,       // Debounced press, sent immediately
+    BUTTON_CLICK,           // Short press released (after the double-click window if enabled)
+    BUTTON_DOUBLE_CLICK,    // Second click inside BUTTON_DOUBLE_CLICK_MS
+    BUTTON_LONG_PRESS,      // Held for BUTTON_LONG_PRESS_MS (sent once)
+    BUTTON_REPEAT,          // Auto-repeat while held (repeat-enabled buttons)
+    BUTTON_COMBO            // Two buttons pressed together; id = BUTTON_COMBO_ID(a, b)
+};
+
+// Combo events carry both buttons in the id field
+#define BUTTON_COMBO_ID(a, b)   (uint8_t)(0x80 | (1 << (a)) | (1 << (b)))
+
+// Called from the button task on every accepted (non-combo) press, before
+// the BUTTON_PRESS event is queued. Keep it to a few report writes; the
+// task stack (STACK_SIZE_BUTTON) is sized for one BLE HID notify.
+typedef void (*ButtonPressHook)(uint8_t id);
+
+// Configure the button GPIOs, attach the edge interrupts and start the
+// button task. Events go to controlQueue, so call after appTasksStart().
+bool buttonsBegin(ButtonPressHook hook = nullptr);
+
+// True while any button is held or a gesture timer is pending
+bool buttonsBusy();
+
+#endif // BUTTONS_H
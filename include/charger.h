@@ -0,0 +1,50 @@
+/**
+ * TP4056 Charge State Estimator
+ *
+ * Combines the charger's STAT line (low while charging) with the filtered
+ * battery voltage from battery_monitor.h:
+ *
+ *   DISCHARGING -> CHARGING     STAT low
+ *   DISCHARGING -> CHARGED      STAT released at or above CHARGE_FULL_MV
+ *                                (full at boot, or no charge was started)
+ *   CHARGING    -> CHARGED      STAT released at or above CHARGE_FULL_MV
+ *                                (the TP4056 terminated the charge)
+ *   CHARGING    -> DISCHARGING  STAT released below CHARGE_FULL_MV
+ *                                (unplugged mid-charge)
+ *   CHARGED     -> CHARGING     STAT low again (top-up recharge)
+ *   CHARGED     -> DISCHARGING  voltage below CHARGE_FULL_MV - CHARGE_HYST_MV
+ *                                (unplugged, the cell relaxes under load)
+ *
+ * The initial state comes from STAT and the first battery reading. Each
+ * STAT edge restarts a one-shot timer of CHARGER_STAT_DEBOUNCE_MS, and the
+ * state is evaluated in the timer task once the level has held that long.
+ * A battery reading schedules the same evaluation, in case an edge was
+ * missed in light sleep. Nothing is polled in between. The callback only
+ * runs on a transition, so listeners never see the state flicker.
+ */
+
+#ifndef CHARGER_H
+#define CHARGER_H
+
+#include <Arduino.h>
+
+enum ChargeState : uint8_t {
+    CHARGE_DISCHARGING = 0,
+    CHARGE_CHARGING,
+    CHARGE_CHARGED
+};
+
+// Timer task context, on every state transition
+typedef void (*ChargeChangeCallback)(ChargeState state);
+
+// Configure the STAT pin interrupt and take the initial state; call after
+// batteryMonitorBegin()
+bool chargerBegin(uint8_t statPin, ChargeChangeCallback onChange);
+
+// Telemetry task: `batteryUpdated` is true when battery_monitor has a new
+// reading, which is re-evaluated against STAT
+void chargerService(bool batteryUpdated);
+
+ChargeState chargerState();
+
+#endif // CHARGER_H
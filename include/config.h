@@ -11,7 +11,10 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+// The DSP settings are also read by the host benchmark (env:native)
+#ifdef ARDUINO
 #include <Arduino.h>
+#endif
 
 // ====================================================================================
 // FIRMWARE VERSION AND INFO
@@ -26,6 +29,8 @@
 // HARDWARE PIN DEFINITIONS
 // ====================================================================================
 
+#define PIN_NONE                0xFF    // Function not wired on this board
+
 // I2C OLED Display
 #define PIN_OLED_SDA            8   // GPIO8 - SDA
 #define PIN_OLED_SCL            9   // GPIO9 - SCL
@@ -33,12 +38,12 @@
 // ADC and Status Monitoring
 #define PIN_BAT_ADC             4   // GPIO4 - Battery voltage divider (ADC1_CH4)
 #define PIN_STAT                3   // GPIO3 - TP4056 STAT line from right cup
-#define PIN_TEMP_SENSOR         2   // GPIO2 - Optional temperature sensor
+#define PIN_TEMP_SENSOR         PIN_NONE    // Optional temperature sensor (GPIO2 is QCC RX)
 
 // Power Control
 #define PIN_EN_AUDIO            10  // GPIO10 - Enable QCC5124 + TPA6120A2 LDO
 #define PIN_EN_MIC              18  // GPIO18 - Enable mic module in right cup (P-MOSFET gate)
-#define PIN_EN_USB              19  // GPIO19 - USB power enable (optional)
+#define PIN_EN_USB              PIN_NONE    // Optional USB power enable (GPIO19 is QCC TX)
 
 // User Interface - Buttons (active low with internal pullup)
 #define PIN_BTN_PWR             20  // GPIO20 - Power button
@@ -47,9 +52,12 @@
 #define PIN_BTN_MUTE            1   // GPIO1 - Mute button
 
 // QCC5124 A2DP Codec Control
-#define PIN_QCC_TX              6   // GPIO6 - UART TX to QCC5124
-#define PIN_QCC_RX              7   // GPIO7 - UART RX from QCC5124
-#define PIN_QCC_RST             2   // GPIO2 - QCC5124 Reset
+// GPIO6/7 belong to the I2S mic. GPIO2 is a strapping pin; the QCC5124 TX
+// line idles high, as the boot mode needs. The codec has no separate reset
+// line: it is held in reset while PIN_EN_AUDIO is low.
+#define PIN_QCC_TX              19  // GPIO19 - UART TX to QCC5124
+#define PIN_QCC_RX              2   // GPIO2 - UART RX from QCC5124
+#define PIN_QCC_RST             PIN_NONE    // Reset follows the audio rail
 
 // I2S Microphone Input (for VAD and audio processing)
 #define PIN_I2S_WS              6   // GPIO6 - I2S Word Select
@@ -57,8 +65,78 @@
 #define PIN_I2S_SD              5   // GPIO5 - I2S Serial Data
 
 // Status LEDs (optional)
-#define PIN_LED_STATUS          8   // GPIO8 - Status LED
-#define PIN_LED_POWER           1   // GPIO1 - Power LED
+#define PIN_LED_STATUS          PIN_NONE    // Status LED (GPIO8 is OLED SDA)
+#define PIN_LED_POWER           PIN_NONE    // Power LED (GPIO1 is the mute button)
+
+// Compile-time checks: every wired function has its own GPIO, and none of
+// them is a flash pin (GPIO11-17) or missing on the ESP32-C3. GPIO18/19 are
+// USB D-/D+; they are only free when neither the console nor flashing uses
+// the USB Serial/JTAG port. This board already wires EN_MIC and QCC TX to
+// them: those two are checked with CONFIG_CHECK_PIN_ON_USB, which warns
+// instead, until the hardware moves them. Any other pin there is an error.
+#if ARDUINO_USB_CDC_ON_BOOT || ARDUINO_USB_MODE
+#define CONFIG_USB_PINS_TAKEN   true
+#else
+#define CONFIG_USB_PINS_TAKEN   false
+#endif
+
+#ifdef __cplusplus
+constexpr uint8_t configPins[] = {
+    PIN_OLED_SDA, PIN_OLED_SCL, PIN_BAT_ADC, PIN_STAT, PIN_TEMP_SENSOR,
+    PIN_EN_AUDIO, PIN_EN_MIC, PIN_EN_USB,
+    PIN_BTN_PWR, PIN_BTN_VOL_UP, PIN_BTN_VOL_DN, PIN_BTN_MUTE,
+    PIN_QCC_TX, PIN_QCC_RX, PIN_QCC_RST,
+    PIN_I2S_WS, PIN_I2S_SCK, PIN_I2S_SD,
+    PIN_LED_STATUS, PIN_LED_POWER,
+};
+
+constexpr unsigned configPinUses(uint8_t pin) {
+    unsigned uses = 0;
+    for (uint8_t p : configPins) {
+        uses += p == pin;
+    }
+    return uses;
+}
+
+constexpr bool configPinOk(uint8_t pin) {
+    return pin == PIN_NONE ||
+           ((pin <= 10 || (pin >= 18 && pin <= 21)) && configPinUses(pin) == 1);
+}
+
+constexpr bool configPinOffUsb(uint8_t pin) {
+    return !CONFIG_USB_PINS_TAKEN || (pin != 18 && pin != 19);
+}
+
+#define CONFIG_CHECK_PIN(pin) \
+    static_assert(configPinOk(pin), #pin " is shared with another function or not a usable GPIO"); \
+    static_assert(configPinOffUsb(pin), #pin " is a USB pin; the console and flashing need it")
+
+// Known USB pin reuse on this board; main.cpp warns about it
+#define CONFIG_CHECK_PIN_ON_USB(pin) \
+    static_assert(configPinOk(pin), #pin " is shared with another function or not a usable GPIO")
+
+CONFIG_CHECK_PIN(PIN_OLED_SDA);
+CONFIG_CHECK_PIN(PIN_OLED_SCL);
+CONFIG_CHECK_PIN(PIN_BAT_ADC);
+CONFIG_CHECK_PIN(PIN_STAT);
+CONFIG_CHECK_PIN(PIN_TEMP_SENSOR);
+CONFIG_CHECK_PIN(PIN_EN_AUDIO);
+CONFIG_CHECK_PIN_ON_USB(PIN_EN_MIC);
+CONFIG_CHECK_PIN(PIN_EN_USB);
+CONFIG_CHECK_PIN(PIN_BTN_PWR);
+CONFIG_CHECK_PIN(PIN_BTN_VOL_UP);
+CONFIG_CHECK_PIN(PIN_BTN_VOL_DN);
+CONFIG_CHECK_PIN(PIN_BTN_MUTE);
+CONFIG_CHECK_PIN_ON_USB(PIN_QCC_TX);
+CONFIG_CHECK_PIN(PIN_QCC_RX);
+CONFIG_CHECK_PIN(PIN_QCC_RST);
+CONFIG_CHECK_PIN(PIN_I2S_WS);
+CONFIG_CHECK_PIN(PIN_I2S_SCK);
+CONFIG_CHECK_PIN(PIN_I2S_SD);
+CONFIG_CHECK_PIN(PIN_LED_STATUS);
+CONFIG_CHECK_PIN(PIN_LED_POWER);
+static_assert(PIN_BAT_ADC <= 4, "PIN_BAT_ADC must be an ADC1 channel (GPIO0-4)");
+#endif
 
 // ====================================================================================
 // DISPLAY CONFIGURATION
@@ -69,7 +147,8 @@
 #define OLED_RESET              -1
 #define OLED_I2C_ADDR           0x3C
 #define DISPLAY_TIMEOUT_MS      30000   // Turn off display after 30 seconds
-#define DISPLAY_UPDATE_RATE_MS  100     // Update display every 100ms
+#define DISPLAY_UPDATE_RATE_MS  100     // Redraw budget; redraws are event-driven
+#define DISPLAY_SHUTDOWN_WAIT_MS 200    // Max wait for the display task to blank the panel
 
 // ====================================================================================
 // BATTERY MONITORING CONFIGURATION
@@ -82,6 +161,10 @@
 #define BAT_LOW_VOLTAGE         3.4f    // Low battery warning
 #define BAT_SAMPLES             64      // ADC averaging samples
 #define BAT_CHECK_INTERVAL_MS   5000    // Check battery every 5 seconds
+#define BAT_FILTER_SHIFT        2       // IIR low-pass weight 1/2^n per reading
+#define CHARGE_FULL_MV          4150    // Charge end at or above this counts as charged
+#define CHARGE_HYST_MV          150     // Charged until this far below CHARGE_FULL_MV
+#define CHARGER_STAT_DEBOUNCE_MS 200    // STAT level must hold this long
 
 // ====================================================================================
 // BUTTON CONFIGURATION
@@ -90,6 +173,7 @@
 #define BUTTON_DEBOUNCE_MS      50      // Debounce time
 #define BUTTON_LONG_PRESS_MS    1000    // Long press threshold
 #define BUTTON_DOUBLE_CLICK_MS  300     // Double click window
+#define BUTTON_REPEAT_DELAY_MS  500     // Hold time before auto-repeat starts
 #define BUTTON_REPEAT_MS        200     // Repeat rate for volume buttons
 #define BUTTON_COMBO_TIMEOUT_MS 500     // Combo button timeout
 
@@ -101,6 +185,7 @@
 #define AUDIO_SAMPLE_RATE       16000   // 16kHz for voice processing
 #define AUDIO_BUFFER_SIZE       512     // Audio buffer size in samples
 #define AUDIO_FRAME_SIZE        160     // 10ms frames at 16kHz
+#define MIC_FRAME_POOL_SIZE     4       // Pipeline frame buffers (static)
 #define AUDIO_CHANNELS          1       // Mono input for mic
 #define AUDIO_BITS_PER_SAMPLE   16      // 16-bit samples
 
@@ -110,6 +195,8 @@
 #define VAD_TRIGGER_MS          50      // Time to trigger VAD
 #define VAD_ENERGY_ALPHA        0.1f    // Energy smoothing factor
 #define VAD_ZCR_THRESHOLD       0.1f    // Zero crossing rate threshold
+#define VAD_NOISE_MARGIN        3.0f    // Speech energy must exceed noise floor by this
+#define VAD_FLOOR_MIN_MS        5000    // Noise floor >= minimum energy over this long
 
 // Noise Suppression
 #define NOISE_GATE_ATTACK_MS    5       // Noise gate attack time
@@ -134,6 +221,59 @@
 #define BT_PAIRING_TIMEOUT_MS   120000  // 2 minutes pairing timeout
 #define BT_RECONNECT_ATTEMPTS   5       // Reconnection attempts
 #define BT_RECONNECT_DELAY_MS   5000    // Delay between reconnection attempts
+#define BT_STATUS_MIN_INTERVAL_MS 50    // Coalesce status changes within this window
+#define BT_STATUS_TEXT_COMPAT   false   // Send legacy "vol,muted,battery" text status
+
+// Connection profiles (ble_link.h): idle trades latency for radio time,
+// active is requested on control/diagnostics traffic
+#define BT_IDLE_INTERVAL_MIN_MS 100     // Idle connection interval range
+#define BT_IDLE_INTERVAL_MAX_MS 200
+#define BT_IDLE_LATENCY         4       // Connection events the headset may skip
+#define BT_IDLE_TIMEOUT_MS      6000    // Supervision timeout
+#define BT_ACTIVE_INTERVAL_MIN_MS 15    // Active connection interval range (7.5 ms steps ok)
+#define BT_ACTIVE_INTERVAL_MAX_MS 30
+#define BT_ACTIVE_TIMEOUT_MS    2000
+#define BT_ACTIVE_HOLD_MS       3000    // Back to idle after this long without traffic
+#define BT_LINK_MTU             247     // Local ATT MTU offered to the peer
+#define BT_ADV_FAST_INTERVAL_MS 30      // Advertising while pairing or reconnecting
+#define BT_ADV_SLOW_INTERVAL_MS 1000    // Advertising after the attempts ran out
+#define BT_RECONNECT_WINDOW_MS  10000   // Fast advertising per reconnection attempt
+
+// Firmware update over BLE (ble_ota.h)
+#define OTA_WINDOW_CHUNKS       16      // Unacknowledged data chunks the host may send
+#define OTA_RING_CHUNKS         32      // Chunks buffered for the flash writer (power of two)
+#define OTA_SESSION_TIMEOUT_MS  120000  // Abort an update without data for this long
+#define OTA_RESTART_DELAY_MS    500     // Restart this long after the DONE notification
+#define OTA_TASK_STACK_SIZE     6144    // Flash writer task stack size (ECDSA verify)
+// Release key for BLE updates: uncompressed P-256 public key, 0x04 || X || Y
+// (see README). The zero default refuses every update.
+#define OTA_SIGNING_PUBLIC_KEY  { 0 }
+
+// Mic audio streaming (mic_stream.h), IMA-ADPCM at 4 bits per sample
+#define MIC_STREAM_MIN_MTU      128     // Smaller MTUs cannot carry 64 kbit/s in the burst
+#define MIC_STREAM_QUEUE_DEPTH  8       // Encoded packets waiting for the radio (power of two)
+#define MIC_STREAM_BURST        8       // Packets notified per telemetry period
+
+// ====================================================================================
+// QCC5124 CODEC LINK
+// ====================================================================================
+
+#define QCC_ACK_TIMEOUT_MS      50      // Resend a frame if no ACK within this time
+#define QCC_MAX_RETRIES         3       // Resends before a command is dropped
+#define QCC_LINK_QUEUE_DEPTH    8       // Commands waiting to be sent
+#define QCC_LINK_STACK_SIZE     3072    // Link task stack size
+#define QCC_UART_BAUD           115200  // Link UART speed
+#define QCC_VOLUME_MAX          15      // Codec volume steps 0..max
+#define QCC_VOLUME_DEFAULT      8       // Volume on first boot
+
+// ====================================================================================
+// AUDIO POWER SEQUENCING
+// ====================================================================================
+
+#define POWER_SEQ_POLL_MS       10      // Sequencer step period while powering up
+#define POWER_RAIL_SETTLE_MS    20      // Audio rail ramp before releasing reset
+#define QCC_BOOT_TIME_MS        100     // QCC5124 boot time after reset release
+#define POWER_CODEC_TIMEOUT_MS  1000    // Max wait for INIT / A2DP enable to be ACKed
 
 // ====================================================================================
 // POWER MANAGEMENT
@@ -145,12 +285,46 @@
 #define POWER_WAKE_ON_AUDIO     true    // Wake on audio activity
 #define POWER_CPU_FREQ_ACTIVE   160     // Active CPU frequency (MHz)
 #define POWER_CPU_FREQ_IDLE     80      // Idle CPU frequency (MHz)
+#define POWER_CPU_FREQ_MIN      40      // DFS floor while no PM lock is held (MHz, XTAL)
+
+// Automatic light sleep, DFS and the PM locks need an IDF build with power
+// management and tickless idle. The stock Arduino-ESP32 sdkconfig sets
+// neither, so there only the CPU frequency steps and deep sleep remain.
+#if CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE
+#define POWER_LIGHT_SLEEP       true
+#else
+#define POWER_LIGHT_SLEEP       false
+#endif
+
+// ====================================================================================
+// PERSISTENT SETTINGS
+// ====================================================================================
+
+#define SETTINGS_NAMESPACE      "headset"   // NVS namespace
+#define SETTINGS_SAVE_DELAY_MS  2000    // Quiet time before a change is written
+#define SETTINGS_RETRY_MAX_MS   60000   // Longest wait between retries of a failed write
+
+// ====================================================================================
+// TELEMETRY TIME SERIES
+// ====================================================================================
+
+// Sample periods (telemetry_log.h); a workday at these rates fits the ring
+#define TELEM_BATTERY_PERIOD_S  60      // Filtered battery voltage
+#define TELEM_CHARGE_PERIOD_S   60      // Charger state
+#define TELEM_VAD_PERIOD_S      30      // VAD duty cycle
+#define TELEM_CPU_PERIOD_S      30      // CPU usage
+#define TELEM_HEAP_PERIOD_S     300     // Heap low-water mark
+#define TELEM_RSSI_PERIOD_S     30      // Link RSSI
+#define TELEM_BLOCK_SIZE        64      // Bytes per block, header included
+#define TELEM_BLOCK_COUNT       128     // Blocks retained (8 KB)
+#define TELEM_EXPORT_BURST      4       // Export notifications per telemetry period
 
 // ====================================================================================
 // SYSTEM TIMING
 // ====================================================================================
 
 #define MAIN_LOOP_DELAY_MS      10      // Main loop delay
+#define TELEMETRY_INTERVAL_MS   100     // Battery/charger/BLE status task period
 #define TASK_STACK_SIZE         4096    // Default task stack size
 #define TASK_PRIORITY_HIGH      5       // High priority tasks
 #define TASK_PRIORITY_NORMAL    3       // Normal priority tasks
@@ -176,6 +350,9 @@
 #define DISCORD_MUTE_COMBO      "ctrl+shift+m"
 #define TEAMS_VIDEO_COMBO       "ctrl+shift+o"
 #define DISCORD_DEAFEN_COMBO    "ctrl+shift+d"
+#define HID_MUTE_COMBO          TEAMS_MUTE_COMBO    // Sent on the mute button press
+#define HID_USB_REPORT_TIMEOUT_MS 2     // Wait for the host to poll a report
+#define HID_HOST_VOLUME         false   // Volume buttons send host volume keys, codec as fallback
 
 // ====================================================================================
 // DEBUG AND LOGGING
@@ -187,6 +364,10 @@
 #define DEBUG_AUDIO_STATS       false   // Enable audio statistics
 #define DEBUG_BATTERY_STATS     false   // Enable battery statistics
 #define DEBUG_BUTTON_EVENTS     false   // Enable button event logging
+#define PROFILER_ENABLED        DEBUG_ENABLED   // Hot-path timers and diagnostics
+#define PROFILER_MAX_TASKS      16      // Tasks listed in a profiler report
+#define LOG_RING_SIZE           64      // Deferred log records (power of two)
+#define LOG_TASK_STACK_SIZE     3072    // Log drain task stack size
 
 // Debug levels
 #define DEBUG_LEVEL_NONE        0       // No debug output
@@ -208,6 +389,10 @@
 #define FEATURE_EQUALIZER       false   // Enable equalizer (resource intensive)
 #define FEATURE_USB_HID         true    // Enable USB HID functionality
 #define FEATURE_BLUETOOTH       true    // Enable Bluetooth functionality
+#define FEATURE_BLE_HID         true    // Shortcut/media keys and Battery Service over BLE
+#define FEATURE_MIC_STREAM      DEBUG_ENABLED   // Processed mic audio over BLE, for diagnostics
+#define FEATURE_TELEMETRY_LOG   true    // In-RAM telemetry series with bulk export
+#define FEATURE_BLE_OTA         true    // Firmware update over BLE
 #define FEATURE_SLEEP_MODE      true    // Enable sleep mode
 
 // ====================================================================================
@@ -218,7 +403,20 @@
 #define STACK_SIZE_MAIN         8192    // Main task stack size
 #define STACK_SIZE_AUDIO        8192    // Audio task stack size
 #define STACK_SIZE_DISPLAY      4096    // Display task stack size
-#define STACK_SIZE_BUTTON       2048    // Button task stack size
+#define STACK_SIZE_BUTTON       4096    // Button task stack size (press hook sends BLE HID)
+#define STACK_SIZE_CONTROL      4096    // Control task stack size (BLE notify, GAP requests)
+
+// Static arena for task stacks, TCBs, queues, the sequencer timer and the
+// PM mutex: every application task's stack plus room for the kernel objects
+#define APP_ARENA_OBJECTS       4096    // TCBs, queue storage, timer, mutex
+#define APP_ARENA_SIZE          (STACK_SIZE_AUDIO + STACK_SIZE_DISPLAY + STACK_SIZE_BUTTON + \
+                                 STACK_SIZE_CONTROL + TASK_STACK_SIZE + QCC_LINK_STACK_SIZE + \
+                                 LOG_TASK_STACK_SIZE + APP_ARENA_OBJECTS + \
+                                 (FEATURE_BLE_OTA ? OTA_TASK_STACK_SIZE : 0))
+
+#define HEAP_CHECK_INTERVAL_MS  5000    // Heap sampling period
+#define HEAP_FRAGMENTATION_MAX  60      // Warn above this % fragmentation
+#define HEAP_LEAK_WARN_BYTES    8192    // Warn when this much is lost since startup
 
 // ====================================================================================
 // ERROR HANDLING
@@ -257,12 +455,16 @@
 // UTILITY MACROS
 // ====================================================================================
 
-// Debug printing macros
+// Debug printing macros. Records go to the deferred log (log_ring.h), so a
+// message costs a few stores on the caller's thread; levels above
+// DEBUG_LEVEL are compiled out.
+#include "log_ring.h"
+
 #if DEBUG_ENABLED
 #define DEBUG_PRINT(level, fmt, ...) \
     do { \
         if (level <= DEBUG_LEVEL) { \
-            Serial.printf("[%s:%d] " fmt "\n", __func__, __LINE__, ##__VA_ARGS__); \
+            logPrint(level, "[%s:%d] " fmt, __func__, __LINE__, ##__VA_ARGS__); \
         } \
     } while (0)
 #else
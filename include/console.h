@@ -0,0 +1,27 @@
+/**
+ * Serial Console Commands
+ *
+ * Line-based text commands on the serial console, polled from the
+ * telemetry task. Replies go back to the same stream.
+ *
+ *   telem          export the telemetry log (telemetry_log.h)
+ *   telem clear    drop every stored telemetry block
+ *   prof           profiler report (profiler.h, PROFILER_ENABLED only)
+ *   prof reset     clear the profiler statistics
+ *
+ * The telemetry commands are always available, so release builds with the
+ * profiler compiled out can still export the log. Unknown lines and lines
+ * longer than CONSOLE_LINE_MAX - 1 characters are ignored.
+ */
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <Arduino.h>
+
+#define CONSOLE_LINE_MAX        24
+
+// Read whatever `console` has buffered and run each completed line
+void consoleService(Stream& console);
+
+#endif // CONSOLE_H
@@ -0,0 +1,45 @@
+/**
+ * Change-Driven OLED Status View
+ *
+ * Caches what is currently on the SSD1306 and, on each render, redraws only
+ * the text rows whose inputs changed. Only the 8-pixel pages those rows
+ * touch are sent, using column/page-addressed partial writes; when nothing
+ * changed no I2C traffic is generated at all.
+ */
+
+#ifndef DISPLAY_VIEW_H
+#define DISPLAY_VIEW_H
+
+#include <Arduino.h>
+#include <Adafruit_SSD1306.h>
+
+// Everything the status screen shows
+struct DisplayState {
+    uint8_t volume;
+    uint8_t batteryPercent;
+    bool muted;
+    bool voice;
+    bool connected;
+    bool charging;
+    bool chargeComplete;
+};
+
+// Attach to an initialized display. The next render redraws everything.
+void displayViewBegin(Adafruit_SSD1306* display);
+
+// Forget the cache, e.g. after something else drew to the panel
+void displayViewInvalidate();
+
+// Switch the panel off/on. While off, renders are skipped; turning it back
+// on forces a full redraw.
+void displayViewSetPower(bool on);
+bool displayViewPowered();
+
+// Bring the panel up to date with `state`. Returns true if any page was
+// written to the display.
+bool displayViewRender(const DisplayState& state);
+
+// Pages sent since boot, for bus load statistics
+uint32_t displayViewPagesSent();
+
+#endif // DISPLAY_VIEW_H
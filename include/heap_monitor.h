@@ -0,0 +1,35 @@
+/**
+ * Heap Monitor
+ *
+ * Samples the 8-bit-capable heap every HEAP_CHECK_INTERVAL_MS: free bytes,
+ * largest free block and the all-time low-water mark. Falling below
+ * HEAP_SIZE_MIN, or the largest block shrinking to less than
+ * HEAP_FRAGMENTATION_MAX % of the free space, raises a warning (serial log
+ * plus the BLE status flag); so does a steady loss against the
+ * post-startup baseline.
+ */
+
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <Arduino.h>
+
+struct HeapStats {
+    uint32_t freeBytes;
+    uint32_t largestBlock;
+    uint32_t minFree;           // Low-water mark since boot
+    int32_t sinceStartup;       // Free bytes gained (+) or lost (-) since begin
+    uint8_t fragmentation;      // 0-100 %: 1 - largest block / free bytes
+};
+
+// Take the baseline; call once startup allocations are done
+void heapMonitorBegin();
+
+// Sample if the interval has elapsed. Returns true when the low-memory
+// state changed.
+bool heapMonitorService();
+
+HeapStats heapMonitorStats();
+bool heapMonitorLow();
+
+#endif // HEAP_MONITOR_H
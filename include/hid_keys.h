@@ -0,0 +1,152 @@
+/**
+ * Host Shortcut Keys (USB HID with BLE HID fallback)
+ *
+ * Sends conferencing shortcuts such as the Teams/Discord mute combo to the
+ * host as HID keyboard reports. The combos in config.h are parsed at compile
+ * time into ready-made 8-byte boot keyboard reports, so a key press is two
+ * report writes (press, release) with no string handling at run time.
+ * Media keys (play/pause, volume, mute) use a one-byte consumer control
+ * report that the OS handles natively.
+ *
+ * Transport: native USB HID when the chip has a USB OTG controller, the
+ * core runs TinyUSB (ARDUINO_USB_MODE=0) and a host has mounted the device;
+ * otherwise the BLE HID service (ble_hid.h) if a bonded host is subscribed.
+ * The ESP32-C3 only has the USB Serial/JTAG controller, so there the BLE
+ * path is the only one compiled in.
+ *
+ * hidKeysSend() is meant to be called straight from the button task on the
+ * press edge. On USB the press report goes out at the next host poll
+ * (1 ms interval); the call returns once both reports are queued. On BLE it
+ * first requests the active link profile (ble_link.h).
+ */
+
+#ifndef HID_KEYS_H
+#define HID_KEYS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define HID_REPORT_ID_KEYS      1
+#define HID_REPORT_ID_MEDIA     2
+
+// Usage IDs from the HID keyboard page
+#define HID_MOD_CTRL            0x01
+#define HID_MOD_SHIFT           0x02
+#define HID_MOD_ALT             0x04
+#define HID_MOD_GUI             0x08
+
+// Boot keyboard input report (report id HID_REPORT_ID_KEYS)
+struct __attribute__((packed)) HidKeyReport {
+    uint8_t modifiers;      // HID_MOD_* bits
+    uint8_t reserved;
+    uint8_t keys[6];        // Keyboard page usages, 0 = none
+};
+
+enum HidShortcut : uint8_t {
+    HID_SHORTCUT_MUTE = 0,  // HID_MUTE_COMBO
+    HID_SHORTCUT_VIDEO,     // TEAMS_VIDEO_COMBO
+    HID_SHORTCUT_DEAFEN,    // DISCORD_DEAFEN_COMBO
+    HID_SHORTCUT_COUNT
+};
+
+// Consumer control report bits (report id HID_REPORT_ID_MEDIA)
+enum HidMediaKey : uint8_t {
+    HID_MEDIA_PLAY_PAUSE    = 0x01,
+    HID_MEDIA_NEXT          = 0x02,
+    HID_MEDIA_PREVIOUS      = 0x04,
+    HID_MEDIA_STOP          = 0x08,
+    HID_MEDIA_MUTE          = 0x10,
+    HID_MEDIA_VOLUME_UP     = 0x20,
+    HID_MEDIA_VOLUME_DOWN   = 0x40
+};
+
+enum HidTransport : uint8_t {
+    HID_TRANSPORT_NONE = 0,
+    HID_TRANSPORT_USB,
+    HID_TRANSPORT_BLE
+};
+
+// Report descriptor shared by the USB and BLE transports
+extern const uint8_t hidReportMap[];
+extern const uint16_t hidReportMapSize;
+
+// Compile-time parsing of "ctrl+shift+m" style combos
+
+struct HidCombo {
+    HidKeyReport report;
+    bool valid;             // Every token known and at least one key
+};
+
+constexpr bool hidTokenIs(const char* token, size_t len, const char* word) {
+    size_t i = 0;
+    for (; i < len && word[i]; i++) {
+        if ((token[i] | 0x20) != word[i]) {
+            return false;
+        }
+    }
+    return i == len && !word[i];
+}
+
+constexpr uint8_t hidModifierUsage(const char* token, size_t len) {
+    return hidTokenIs(token, len, "ctrl") ? HID_MOD_CTRL :
+           hidTokenIs(token, len, "shift") ? HID_MOD_SHIFT :
+           hidTokenIs(token, len, "alt") ? HID_MOD_ALT :
+           hidTokenIs(token, len, "gui") || hidTokenIs(token, len, "win") ||
+           hidTokenIs(token, len, "cmd") ? HID_MOD_GUI : 0;
+}
+
+constexpr uint8_t hidKeyUsage(const char* token, size_t len) {
+    if (len != 1) {
+        return 0;
+    }
+    char c = token[0] | 0x20;
+    if (c >= 'a' && c <= 'z') return 0x04 + (c - 'a');
+    if (token[0] >= '1' && token[0] <= '9') return 0x1E + (token[0] - '1');
+    if (token[0] == '0') return 0x27;
+    return 0;
+}
+
+constexpr HidCombo hidParseCombo(const char* combo) {
+    HidCombo result = { { 0, 0, { 0, 0, 0, 0, 0, 0 } }, true };
+    size_t keys = 0;
+    const char* token = combo;
+    for (const char* p = combo; ; p++) {
+        if (*p != '+' && *p != '\0') {
+            continue;
+        }
+        size_t len = p - token;
+        uint8_t modifier = hidModifierUsage(token, len);
+        uint8_t key = hidKeyUsage(token, len);
+        if (modifier) {
+            result.report.modifiers |= modifier;
+        } else if (key && keys < 6) {
+            result.report.keys[keys++] = key;
+        } else {
+            result.valid = false;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        token = p + 1;
+    }
+    result.valid = result.valid && keys > 0;
+    return result;
+}
+
+// Start the USB HID device when the chip and core support it. The BLE
+// transport is started separately by bleHidBegin() in initBLE().
+bool hidKeysBegin();
+
+// Press and release a shortcut on the best available transport. Returns
+// false when no host is listening. Task context, not ISR safe.
+bool hidKeysSend(HidShortcut shortcut);
+
+// Press and release a media key; same transports and rules as hidKeysSend()
+bool hidKeysSendMedia(HidMediaKey key);
+
+// Transport the next hidKeysSend() would use
+HidTransport hidKeysTransport();
+
+uint32_t hidKeysSentCount();
+
+#endif // HID_KEYS_H
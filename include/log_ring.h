@@ -0,0 +1,69 @@
+/**
+ * Deferred Binary Log
+ *
+ * DEBUG_PRINT and logPrint() do not format anything on the caller's
+ * thread. They store a compact record in a lock-free ring: a pointer to
+ * the format string, a millisecond timestamp, the level and up to
+ * LOG_MAX_ARGS 32-bit arguments. A low-priority task formats and writes
+ * the records to Serial later. Posting is safe from any task or ISR and
+ * never blocks. When the ring is full the record is dropped and counted;
+ * the drain task reports the count.
+ *
+ * Because formatting is deferred, arguments must be 32-bit integers or
+ * pointers, and every %s argument must point at a string that outlives
+ * the record (literals, static tables). Floats and 64-bit values are
+ * rejected at compile time.
+ */
+
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <type_traits>
+
+#define LOG_MAX_ARGS            8
+
+// Same values as config.h's DEBUG_LEVEL_*
+enum LogLevel : uint8_t {
+    LOG_LEVEL_ERROR = 1,
+    LOG_LEVEL_WARNING,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_DEBUG
+};
+
+// Start the drain task; records posted earlier are kept until it runs
+bool logRingBegin();
+
+void logRingPost(uint8_t level, const char* format, const uint32_t* args, uint8_t count);
+
+// Format and write everything queued, on the caller's thread (e.g. right
+// before deep sleep or a restart)
+void logRingFlush();
+
+// Records lost to a full ring since boot
+uint32_t logRingDropped();
+
+template <typename T>
+inline uint32_t logArg(T value) {
+    static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                  "log arguments must be integers or pointers; format floats first");
+    static_assert(sizeof(T) <= sizeof(uint32_t), "64-bit log arguments are not supported");
+    return (uint32_t)value;
+}
+
+// Pointers are 32-bit on the target
+template <typename T>
+inline uint32_t logArg(T* pointer) {
+    return (uint32_t)(uintptr_t)pointer;
+}
+
+// Level-filtered at run time; DEBUG_PRINT also filters at compile time
+template <typename... Args>
+inline void logPrint(uint8_t level, const char* format, Args... args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "too many log arguments");
+    const uint32_t packed[sizeof...(Args) + 1] = { logArg(args)..., 0 };
+    logRingPost(level, format, packed, sizeof...(Args));
+}
+
+#endif // LOG_RING_H
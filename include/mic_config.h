@@ -0,0 +1,48 @@
+/**
+ * Microphone DSP Settings
+ *
+ * The VAD, noise suppressor and AGC configurations derived from config.h.
+ * Shared by the firmware pipeline and the host benchmark (bench/), so both
+ * run the kernels with identical parameters. Unlike other headers this one
+ * includes config.h: it exists to expose those values.
+ */
+
+#ifndef MIC_CONFIG_H
+#define MIC_CONFIG_H
+
+#include "config.h"
+#include "vad.h"
+#include "noise_suppressor.h"
+#include "agc.h"
+
+#define MIC_FRAME_MS            (AUDIO_FRAME_SIZE * 1000 / AUDIO_SAMPLE_RATE)
+
+static_assert(AUDIO_FRAME_SIZE == NS_HOP, "noise suppressor hop must match the capture frame");
+
+static const VadConfig vadConfig = {
+    dspThresholdQ30(VAD_THRESHOLD),
+    (uint16_t)(VAD_NOISE_MARGIN * 256),
+    dspQ15(VAD_ENERGY_ALPHA),
+    dspQ15(NOISE_FLOOR_ALPHA),
+    (uint16_t)(VAD_ZCR_THRESHOLD * AUDIO_FRAME_SIZE),
+    VAD_TRIGGER_MS / MIC_FRAME_MS,
+    VAD_HANGOVER_MS / MIC_FRAME_MS,
+    VAD_FLOOR_MIN_MS / MIC_FRAME_MS / VAD_MIN_BLOCKS,
+};
+
+static const NoiseSuppressorConfig nsConfig = {
+    true,
+    dspQ15(SPECTRAL_FLOOR),
+    dspQ15(NOISE_FLOOR_ALPHA),
+};
+
+static const AgcConfig agcConfig = {
+    dspQ15(AGC_TARGET_LEVEL),
+    AGC_ATTACK_MS,
+    AGC_RELEASE_MS,
+    MIC_FRAME_MS,
+    (int32_t)(AGC_MIN_GAIN * AGC_GAIN_ONE),
+    (int32_t)(AGC_MAX_GAIN * AGC_GAIN_ONE),
+};
+
+#endif // MIC_CONFIG_H
@@ -0,0 +1,46 @@
+/**
+ * Microphone Processing Pipeline
+ *
+ *   I2S capture -> VAD -> noise suppressor -> AGC -> sinks
+ *
+ * Built from audio_pipeline.h: frames come from a static pool and every
+ * stage works in place. Each stage is compiled in only if its FEATURE_*
+ * flag is set (FEATURE_VAD, FEATURE_NOISE_REDUCTION, FEATURE_AGC).
+ *
+ * micPipelineRun() is the whole body of the audio task.
+ */
+
+#ifndef MIC_PIPELINE_H
+#define MIC_PIPELINE_H
+
+#include <Arduino.h>
+
+// Called from the audio task when the VAD decision changes
+typedef void (*VoiceChangeCallback)(bool voice);
+
+struct MicPipelineStats {
+    uint32_t frames;
+    uint32_t voiceFrames;       // Frames the VAD marked as voice
+    uint32_t cyclesLast;        // CPU cycles of the stages for the last frame
+    uint32_t cyclesPeak;
+    uint8_t poolLowWater;       // Fewest free frames seen
+    uint32_t poolExhausted;     // Frames dropped for lack of a buffer
+};
+
+void micPipelineBegin(uint32_t vadThresholdQ30, uint8_t nrLevel,
+                      VoiceChangeCallback onVoiceChange);
+
+// Capture, process and deliver one frame; blocks up to `timeout` waiting
+// for the microphone. Returns false if no frame was processed.
+bool micPipelineRun(TickType_t timeout);
+
+// Restart detector and filter state before the next frame (any task)
+void micPipelineReset();
+
+// Runtime tuning (any task)
+void micPipelineSetVadThreshold(uint32_t thresholdQ30);
+void micPipelineSetNrLevel(uint8_t percent);
+
+MicPipelineStats micPipelineStats();
+
+#endif // MIC_PIPELINE_H
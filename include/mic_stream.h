@@ -0,0 +1,59 @@
+/**
+ * Mic Audio Streaming over BLE
+ *
+ * Opt-in diagnostics stream of the processed mic signal (after NR and AGC).
+ * Nothing is encoded or sent until a host subscribes to the stream
+ * characteristic on a link whose MTU is at least MIC_STREAM_MIN_MTU.
+ *
+ * The audio task encodes each frame with IMA-ADPCM (adpcm.h, 4:1) straight
+ * into a packet slot of an SPSC ring (spsc_ring.h), sized to the negotiated
+ * MTU. The telemetry task notifies at most MIC_STREAM_BURST packets per
+ * period straight from their slots, after the status record has gone out,
+ * so the control characteristic always gets its turn. When the radio falls
+ * behind, packets are dropped at the ring and the sequence number shows the
+ * gap.
+ *
+ * Packet (one notification, little endian):
+ *
+ *   [sequence u16][predictor i16][stepIndex u8][flags u8][ADPCM bytes ...]
+ *
+ * predictor/stepIndex are the encoder state before the first sample of the
+ * packet, so every packet decodes on its own and a lost packet costs only
+ * its own samples. Two samples per byte, low nibble first; AUDIO_SAMPLE_RATE
+ * mono. MIC_STREAM_FLAG_START marks the first packet after (re)starting.
+ */
+
+#ifndef MIC_STREAM_H
+#define MIC_STREAM_H
+
+#include <Arduino.h>
+
+class BLEService;
+
+#define MIC_STREAM_FLAG_START   0x01
+
+struct __attribute__((packed)) MicStreamHeader {
+    uint16_t sequence;
+    int16_t predictor;
+    uint8_t stepIndex;
+    uint8_t flags;          // MIC_STREAM_FLAG_*
+};
+
+struct MicStreamStats {
+    uint32_t packetsSent;
+    uint32_t packetsDropped;    // Ring full; visible as sequence gaps
+    uint16_t payloadBytes;      // ADPCM bytes per packet, 0 while stopped
+};
+
+// Add the stream characteristic to `service`
+void micStreamBegin(BLEService* service);
+
+// Audio task: encode one processed frame (even sample count)
+void micStreamProcess(const int16_t* samples, size_t count);
+
+// Telemetry task: follow the subscription and notify queued packets
+void micStreamService(bool connected);
+
+MicStreamStats micStreamStats();
+
+#endif // MIC_STREAM_H
@@ -0,0 +1,64 @@
+/**
+ * CPU Power Manager
+ *
+ * Subsystems that need full clocks hold a PowerLock; while no lock is held
+ * the CPU may drop into automatic light sleep between ticks (the buttons
+ * wake it). After POWER_SAVE_TIMEOUT_MS without user activity and with no
+ * lock held, the maximum CPU frequency steps down to POWER_CPU_FREQ_IDLE.
+ * After POWER_DEEP_SLEEP_MS the chip goes into deep sleep with GPIO wake on
+ * the wake-capable button pins.
+ *
+ * Light sleep needs POWER_LIGHT_SLEEP (config.h): an sdkconfig with
+ * CONFIG_PM_ENABLE and CONFIG_FREERTOS_USE_TICKLESS_IDLE. The stock
+ * Arduino-ESP32 core sets neither; there the locks only select the mode,
+ * the CPU runs at a fixed frequency per mode, and the build warns at
+ * compile time and at boot.
+ *
+ * Time spent in each mode is accumulated in RTC memory, so the counters
+ * cover deep sleep and survive the wake-up reset.
+ */
+
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+
+enum PowerLock : uint8_t {
+    PM_LOCK_AUDIO = 0,      // Mic capture running (I2S needs a stable APB clock)
+    PM_LOCK_CODEC,          // QCC5124 powered (UART needs a stable APB clock)
+    PM_LOCK_BLE,            // BLE client connected
+    PM_LOCK_COUNT
+};
+
+enum PowerMode : uint8_t {
+    PM_MODE_ACTIVE = 0,     // At least one lock held
+    PM_MODE_IDLE,           // No lock; light sleep allowed (POWER_LIGHT_SLEEP)
+    PM_MODE_POWER_SAVE,     // Idle timeout passed; reduced CPU frequency
+    PM_MODE_DEEP_SLEEP,
+    PM_MODE_COUNT
+};
+
+// Called right before deep sleep, e.g. to switch the display off
+typedef void (*PowerSleepCallback)();
+
+bool powerManagerBegin(PowerSleepCallback beforeDeepSleep = nullptr);
+
+// Take or release a lock; repeated calls with the same state are no-ops
+void powerManagerLock(PowerLock lock, bool held);
+
+// User activity (button, BLE command): restarts the idle timeouts
+void powerManagerActivity();
+
+// Evaluate the timeouts; call periodically from a low-priority task
+void powerManagerService();
+
+PowerMode powerManagerMode();
+const char* powerManagerModeName(PowerMode mode);
+
+// Milliseconds spent in `mode` since the last cold boot
+uint32_t powerManagerResidencyMs(PowerMode mode);
+
+// True if this boot is a wake-up from deep sleep
+bool powerManagerResumed();
+
+#endif // POWER_MANAGER_H
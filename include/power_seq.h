@@ -0,0 +1,57 @@
+/**
+ * Asynchronous Audio Power-Up Sequencer
+ *
+ * Brings the QCC5124 + amplifier rail up without blocking any task:
+ *
+ *   OFF -> RAIL_ENABLE -> RESET_RELEASE -> CODEC_INIT -> A2DP_ENABLE -> READY
+ *
+ * A software timer steps the machine every POWER_SEQ_POLL_MS while a
+ * sequence is running. Timed states wait out their settle time; the codec
+ * states advance when the QCC link reports the ACK. Each state has its own
+ * timeout and ends in FAULT if it expires. FAULT holds the codec in reset
+ * with the rail off, like OFF; a new power-on request starts over.
+ * Power-off is immediate.
+ */
+
+#ifndef POWER_SEQ_H
+#define POWER_SEQ_H
+
+#include <Arduino.h>
+
+enum PowerState : uint8_t {
+    POWER_OFF = 0,
+    POWER_RAIL_ENABLE,
+    POWER_RESET_RELEASE,
+    POWER_CODEC_INIT,
+    POWER_A2DP_ENABLE,
+    POWER_READY,
+    POWER_FAULT
+};
+
+struct PowerSeqHooks {
+    // Queue the application's codec settings (volume, mute) after INIT
+    void (*codecSettings)();
+    // Every state change, called from the timer task
+    void (*stateChanged)(PowerState state);
+};
+
+// `resetPin` may be PIN_NONE when the codec resets with its rail
+bool powerSeqBegin(uint8_t railPin, uint8_t resetPin, const PowerSeqHooks& hooks);
+
+// Start the power-up sequence, or power down immediately
+void powerSeqRequest(bool on);
+
+PowerState powerSeqState();
+
+// True from a power-on request until power-off or FAULT
+bool powerSeqRequested();
+
+const char* powerSeqStateName(PowerState state);
+
+// True once the codec accepts commands (CODEC_INIT and later)
+bool powerSeqCodecUp();
+
+// Milliseconds from the last power-on request to READY (0 if never reached)
+uint32_t powerSeqTimeToReadyMs();
+
+#endif // POWER_SEQ_H
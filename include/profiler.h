@@ -0,0 +1,100 @@
+/**
+ * Hot-Path Profiler
+ *
+ * PROFILE_SCOPE(site) times the rest of the enclosing block with the CPU
+ * cycle counter and feeds the site's statistics: count, min/avg/max, a
+ * half-octave histogram for the p99, and deadline misses against the
+ * site's budget in wall-clock microseconds (cycles alone would drift with
+ * DFS). FreeRTOS task states, stack headroom and, where the kernel keeps
+ * them, run-time counters are added to every report.
+ *
+ * Reports go out as text on the serial console ("prof", "prof reset"; see
+ * console.h) and as a binary record on the BLE diagnostics characteristic:
+ *
+ *   [version u8][siteCount u8][cpuMhz u16]
+ *   siteCount x [count u32][min u32][avg u32][max u32][p99 u32][misses u16]
+ *   [taskCount u8]
+ *   taskCount x [name char[8]][cpuPercent u8][stackFreeBytes u16]
+ *
+ * All cycle figures are CPU cycles; the fields are little endian.
+ *
+ * Everything compiles out when PROFILER_ENABLED (config.h, follows
+ * DEBUG_ENABLED) is false: scopes become empty objects and the report
+ * entry points do nothing. A file using PROFILE_SCOPE must include
+ * config.h.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include <hal/cpu_hal.h>
+#include <esp_timer.h>
+
+class BLEService;
+
+#define PROFILER_VERSION        1
+
+enum ProfileSite : uint8_t {
+    PROF_MIC_FRAME = 0,     // All mic stages for one frame
+    PROF_VAD,
+    PROF_NOISE,
+    PROF_AGC,
+    PROF_DISPLAY,           // displayViewRender()
+    PROF_BLE_NOTIFY,        // One status notification
+    PROF_MIC_STREAM,        // ADPCM encode and packing of one mic frame
+    PROF_SITE_COUNT
+};
+
+struct ProfileStats {
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t avgCycles;
+    uint32_t maxCycles;
+    uint32_t p99Cycles;         // Upper edge of the p99 histogram bucket
+    uint32_t deadlineMisses;
+};
+
+void profilerRecord(ProfileSite site, uint32_t cycles, uint32_t micros);
+
+ProfileStats profilerStats(ProfileSite site);
+const char* profilerSiteName(ProfileSite site);
+void profilerReset();
+
+// Sites and tasks as a text table
+void profilerPrint(Print& out);
+
+// Add the read-only diagnostics characteristic to `service`
+void profilerDiagnosticsBegin(BLEService* service);
+
+template <bool Enabled>
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfileSite) {}
+};
+
+template <>
+class ProfileScope<true> {
+public:
+    explicit ProfileScope(ProfileSite site)
+        : site(site),
+          startCycles(cpu_hal_get_cycle_count()),
+          startMicros((uint32_t)esp_timer_get_time()) {}
+
+    ~ProfileScope() {
+        profilerRecord(site, cpu_hal_get_cycle_count() - startCycles,
+                       (uint32_t)esp_timer_get_time() - startMicros);
+    }
+
+private:
+    ProfileSite site;
+    uint32_t startCycles;
+    uint32_t startMicros;
+};
+
+#define PROFILE_CONCAT_(a, b)   a##b
+#define PROFILE_CONCAT(a, b)    PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(site) \
+    ProfileScope<PROFILER_ENABLED> PROFILE_CONCAT(profileScope, __LINE__)(site)
+
+#endif // PROFILER_H
@@ -0,0 +1,70 @@
+/**
+ * Framed, Acknowledged QCC5124 UART Link
+ *
+ * Commands to the QCC5124 are queued and sent asynchronously by the link
+ * task; callers never block on the UART. Every frame carries a sequence
+ * number and CRC and must be acknowledged:
+ *
+ *   [0xAA][seq][cmd][len][payload: len bytes][crc8]
+ *
+ * crc8 is CRC-8 (poly 0x07, init 0x00) over seq..payload. The codec answers
+ * with cmd QCC_CMD_ACK or QCC_CMD_NAK carrying the same seq. Unanswered or
+ * NAKed frames are resent up to QCC_MAX_RETRIES times, QCC_ACK_TIMEOUT_MS
+ * apart. Commands are delivered in submission order, one in flight at a time.
+ *
+ * Commands that supersede each other (volume, mute) coalesce while queued:
+ * five quick volume steps become a single "set volume" with the final level.
+ *
+ * Received bytes are moved in bulk from the UART driver into an SPSC ring
+ * (spsc_ring.h) in its receive callback and parsed by the link task.
+ */
+
+#ifndef QCC_LINK_H
+#define QCC_LINK_H
+
+#include <Arduino.h>
+
+// Command set
+#define QCC_CMD_INIT            0x00
+#define QCC_CMD_SET_VOLUME      0x01    // payload: level 0-15
+#define QCC_CMD_MUTE            0x03    // payload: 0/1
+#define QCC_CMD_A2DP_ENABLE     0x04    // payload: 0/1
+#define QCC_CMD_ACK             0x80    // codec -> host
+#define QCC_CMD_NAK             0x81    // codec -> host, payload: reason
+
+#define QCC_MAX_PAYLOAD         16
+
+// Called from the link task when a command is acknowledged (ok = true) or
+// dropped after its last retry (ok = false)
+typedef void (*QccCompleteCallback)(uint8_t cmd, bool ok);
+
+// Bind to an already started UART and start the link task
+bool qccLinkBegin(HardwareSerial* uart);
+
+// Queue a command. Returns false if the queue is full or the payload is too
+// long. Never blocks.
+bool qccLinkSubmit(uint8_t cmd, const uint8_t* payload = nullptr, uint8_t length = 0);
+bool qccLinkSubmit(uint8_t cmd, uint8_t value);
+
+// Drop everything queued or in flight (e.g. the codec was powered off)
+void qccLinkReset();
+
+void qccLinkOnComplete(QccCompleteCallback callback);
+
+// True when nothing is queued or awaiting an ACK
+bool qccLinkIdle();
+
+struct QccLinkStats {
+    uint32_t framesSent;        // Including retries
+    uint32_t retries;
+    uint32_t acks;
+    uint32_t naks;
+    uint32_t dropped;           // Gave up after QCC_MAX_RETRIES
+    uint32_t coalesced;         // Commands merged into a queued one
+    uint32_t rxCrcErrors;
+    uint32_t rxOverflows;       // Received bytes lost to a full ring
+};
+
+QccLinkStats qccLinkStats();
+
+#endif // QCC_LINK_H
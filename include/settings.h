@@ -0,0 +1,48 @@
+/**
+ * Persisted User Settings
+ *
+ * Volume, mute, VAD threshold and noise reduction level survive a reboot.
+ * They are kept in NVS as one versioned blob, so startup costs a single
+ * read. Changes only update the RAM copy; settingsService() writes the
+ * blob once nothing has changed for SETTINGS_SAVE_DELAY_MS, so a whole
+ * volume sweep costs one flash write. Nothing is written when the values
+ * end up where they were. A failed write keeps the change pending and is
+ * retried, the delay doubling up to SETTINGS_RETRY_MAX_MS.
+ *
+ * A store that is blank, from another layout version or out of range
+ * leaves the caller's defaults in place.
+ */
+
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <Arduino.h>
+
+struct Settings {
+    uint8_t volume;             // 0-QCC_VOLUME_MAX
+    bool muted;
+    uint32_t vadThresholdQ30;   // Mean-square threshold, see dsp.h
+    uint8_t nrLevel;            // Noise reduction strength, 0-100 %
+};
+
+// Open the store and load the saved settings over `defaults`
+bool settingsBegin(const Settings& defaults);
+
+Settings settingsGet();
+
+// Any task; written later by settingsService()
+void settingsSetVolume(uint8_t volume);
+void settingsSetMuted(bool muted);
+void settingsSetVadThreshold(uint32_t thresholdQ30);
+void settingsSetNrLevel(uint8_t percent);
+
+// Write a pending change once the delay has passed (telemetry task)
+void settingsService();
+
+// Write a pending change now, e.g. before deep sleep
+void settingsFlush();
+
+// Blob writes since boot
+uint32_t settingsWriteCount();
+
+#endif // SETTINGS_H
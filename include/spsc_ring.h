@@ -0,0 +1,139 @@
+/**
+ * Lock-Free Single-Producer / Single-Consumer Ring
+ *
+ * Transport for streams between exactly one writer and one reader (an
+ * interrupt or driver callback and a task, or two tasks) without a critical
+ * section or a copy through a kernel queue:
+ *
+ *   producer:  writeSpan() -> fill slots in place -> commitWrite(n)
+ *              or push() / push(items, n) to copy in
+ *   consumer:  peek() -> use slots in place -> commitRead(n)
+ *              or pop() to copy out
+ *
+ * Capacity is a power of two; the indices run freely and are masked on
+ * access, so all N slots are usable. head_ is only written by the producer
+ * and tail_ only by the consumer, each published with a release store and
+ * read on the other side with an acquire load. They sit on separate cache
+ * lines (SPSC_CACHE_LINE) so a multi-core host does not bounce them
+ * between cores; on the ESP32-C3 it only costs a few bytes of padding.
+ *
+ * Spans are contiguous runs up to the end of the buffer; a wrapped region
+ * takes two rounds. Low-rate control events stay on FreeRTOS queues, which
+ * also block and wake the receiver.
+ *
+ * Header-only and hardware-independent.
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef SPSC_CACHE_LINE
+#define SPSC_CACHE_LINE         32
+#endif
+
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    static constexpr size_t capacity = N;
+
+    // Producer side
+
+    // Free slots from the head to the end of the buffer or the tail
+    size_t writeSpan(T** slot) {
+        uint32_t head = __atomic_load_n(&head_, __ATOMIC_RELAXED);
+        uint32_t tail = __atomic_load_n(&tail_, __ATOMIC_ACQUIRE);
+        size_t free = N - (size_t)(head - tail);
+        size_t toEnd = N - (head & (N - 1));
+        *slot = &items_[head & (N - 1)];
+        return free < toEnd ? free : toEnd;
+    }
+
+    // Publish `count` slots filled through writeSpan()
+    void commitWrite(size_t count) {
+        uint32_t head = __atomic_load_n(&head_, __ATOMIC_RELAXED);
+        __atomic_store_n(&head_, head + (uint32_t)count, __ATOMIC_RELEASE);
+    }
+
+    bool push(const T& item) {
+        T* slot;
+        if (!writeSpan(&slot)) {
+            return false;
+        }
+        *slot = item;
+        commitWrite(1);
+        return true;
+    }
+
+    // Copy in as many of `items` as fit; returns the number written
+    size_t push(const T* items, size_t count) {
+        size_t written = 0;
+        while (written < count) {
+            T* slot;
+            size_t span = writeSpan(&slot);
+            if (!span) {
+                break;
+            }
+            size_t n = count - written < span ? count - written : span;
+            for (size_t i = 0; i < n; i++) {
+                slot[i] = items[written + i];
+            }
+            commitWrite(n);
+            written += n;
+        }
+        return written;
+    }
+
+    // Consumer side
+
+    // Readable slots from the tail to the end of the buffer or the head
+    size_t peek(const T** slot) const {
+        uint32_t tail = __atomic_load_n(&tail_, __ATOMIC_RELAXED);
+        uint32_t head = __atomic_load_n(&head_, __ATOMIC_ACQUIRE);
+        size_t used = (size_t)(head - tail);
+        size_t toEnd = N - (tail & (N - 1));
+        *slot = &items_[tail & (N - 1)];
+        return used < toEnd ? used : toEnd;
+    }
+
+    // Hand `count` peeked slots back to the producer
+    void commitRead(size_t count) {
+        uint32_t tail = __atomic_load_n(&tail_, __ATOMIC_RELAXED);
+        __atomic_store_n(&tail_, tail + (uint32_t)count, __ATOMIC_RELEASE);
+    }
+
+    bool pop(T& item) {
+        const T* slot;
+        if (!peek(&slot)) {
+            return false;
+        }
+        item = *slot;
+        commitRead(1);
+        return true;
+    }
+
+    // Drop everything readable; consumer side only
+    void clear() {
+        __atomic_store_n(&tail_, __atomic_load_n(&head_, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+    }
+
+    // Either side; a snapshot that may be stale by the time it is used
+    size_t size() const {
+        // Tail first: it never passes the head read after it
+        uint32_t tail = __atomic_load_n(&tail_, __ATOMIC_ACQUIRE);
+        return (size_t)(__atomic_load_n(&head_, __ATOMIC_ACQUIRE) - tail);
+    }
+    bool empty() const { return size() == 0; }
+    size_t space() const { return N - size(); }
+
+private:
+    alignas(SPSC_CACHE_LINE) uint32_t head_ = 0;
+    alignas(SPSC_CACHE_LINE) uint32_t tail_ = 0;
+    alignas(SPSC_CACHE_LINE) T items_[N];
+};
+
+#endif // SPSC_RING_H
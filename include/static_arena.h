@@ -0,0 +1,38 @@
+/**
+ * Static Memory Arena
+ *
+ * One block of APP_ARENA_SIZE bytes, reserved at link time, from which the
+ * application carves its long-lived buffers during startup: task stacks
+ * and control blocks, queues, timers and mutexes. Allocation is a pointer
+ * bump; nothing is ever freed, so the arena cannot fragment. Once setup()
+ * is done the arena is sealed and any later allocation fails loudly,
+ * which keeps the steady state free of application heap traffic.
+ *
+ * The arenaCreate* helpers wrap the FreeRTOS xxxCreateStatic() calls.
+ */
+
+#ifndef STATIC_ARENA_H
+#define STATIC_ARENA_H
+
+#include <Arduino.h>
+
+// `bytes` aligned to `align` (a power of two), or nullptr if the arena is
+// full or sealed
+void* arenaAlloc(size_t bytes, size_t align = 8);
+
+// Forbid further allocation; logs the final usage
+void arenaSeal();
+
+size_t arenaUsed();
+size_t arenaCapacity();
+uint32_t arenaFailures();
+
+// FreeRTOS objects backed by the arena (nullptr on failure)
+TaskHandle_t arenaCreateTask(TaskFunction_t function, const char* name, uint32_t stackBytes,
+                             void* param, UBaseType_t priority);
+QueueHandle_t arenaCreateQueue(UBaseType_t length, UBaseType_t itemSize);
+TimerHandle_t arenaCreateTimer(const char* name, TickType_t period, bool autoReload,
+                               void* id, TimerCallbackFunction_t callback);
+SemaphoreHandle_t arenaCreateMutex();
+
+#endif // STATIC_ARENA_H
@@ -0,0 +1,101 @@
+/**
+ * Telemetry Time Series
+ *
+ * Long-running series kept in RAM for characterizing a whole day of use:
+ *
+ *   TELEM_BATTERY_MV   filtered battery voltage, mV
+ *   TELEM_CHARGE       ChargeState (charger.h): 0 discharging, 1 charging,
+ *                      2 charged
+ *   TELEM_VAD_DUTY     % of mic frames marked as voice since the last sample
+ *   TELEM_CPU          % CPU busy since the last sample
+ *   TELEM_HEAP_MIN     heap low-water mark, bytes
+ *   TELEM_RSSI         link RSSI, dBm
+ *
+ * Each series is sampled at its own TELEM_*_PERIOD_S from the telemetry
+ * task. Samples are delta-coded into fixed-size blocks of TELEM_BLOCK_SIZE
+ * bytes. Full blocks go into a ring of TELEM_BLOCK_COUNT that overwrites its
+ * oldest block. A block ends early when a sample is missing, e.g. no RSSI
+ * while disconnected or no VAD duty while the mic is off, so every block
+ * has a fixed sample period.
+ *
+ * Nothing goes out on its own. An export (BLE write or the "telem" console
+ * command) first closes the open blocks, then sends every block in the ring
+ * in a few large batches.
+ *
+ * Block (little endian):
+ *
+ *   [sequence u16][series u8][count u8][bytes u8][periodS u16][startS u32]
+ *   [first i32][deltas: bytes]
+ *
+ * startS is the uptime of the first sample. Sample i is at
+ * startS + i * periodS. `deltas` holds count - 1 zigzag varints (7 bits per
+ * byte, low group first, bit 7 = more) of the difference from the previous
+ * sample. sequence numbers blocks in order of completion, across all series.
+ *
+ * BLE characteristic TELEM_UUID (write, notify):
+ *
+ *   write  [TELEM_CMD_EXPORT] or [TELEM_CMD_EXPORT][fromSequence u16]
+ *            all retained blocks, or those from fromSequence on
+ *          [TELEM_CMD_CLEAR]
+ *            drop every block
+ *   notify [version u8][blockCount u8][blocks ...]
+ *            as many whole blocks as fit the MTU. blockCount 0 ends the
+ *            export.
+ *
+ * Running CPU usage comes from the idle task's run-time counter where the
+ * kernel keeps one. Otherwise it is the mic DSP share of the CPU.
+ */
+
+#ifndef TELEMETRY_LOG_H
+#define TELEMETRY_LOG_H
+
+#include <Arduino.h>
+
+class BLEService;
+
+#define TELEM_VERSION           1
+#define TELEM_CMD_EXPORT        0x01
+#define TELEM_CMD_CLEAR         0x02
+
+enum TelemetrySeries : uint8_t {
+    TELEM_BATTERY_MV = 0,
+    TELEM_CHARGE,
+    TELEM_VAD_DUTY,
+    TELEM_CPU,
+    TELEM_HEAP_MIN,
+    TELEM_RSSI,
+    TELEM_SERIES_COUNT
+};
+
+struct __attribute__((packed)) TelemetryBlockHeader {
+    uint16_t sequence;
+    uint8_t series;         // TelemetrySeries
+    uint8_t count;          // Samples, including `first`
+    uint8_t bytes;          // Delta bytes that follow
+    uint16_t periodS;
+    uint32_t startS;
+    int32_t first;
+};
+
+struct TelemetryLogStats {
+    uint16_t blocks;            // Complete blocks retained
+    uint32_t blocksOverwritten; // Lost to the ring wrapping before an export
+    uint32_t samples;
+};
+
+void telemetryLogBegin();
+
+// Add the export characteristic to `service`
+void telemetryLogBleBegin(BLEService* service);
+
+// Telemetry task: take due samples and send pending export batches
+void telemetryLogService(bool connected);
+
+// Telemetry task: every retained block as hex, one line per block
+void telemetryLogPrint(Print& out);
+
+void telemetryLogClear();
+
+TelemetryLogStats telemetryLogStats();
+
+#endif // TELEMETRY_LOG_H
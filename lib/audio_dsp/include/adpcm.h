@@ -0,0 +1,32 @@
+/**
+ * IMA-ADPCM Codec
+ *
+ * 4 bits per sample (4:1 against 16-bit PCM) with the standard IMA step
+ * table, so any stock IMA-ADPCM decoder can play the output. Integer only:
+ * a table lookup, shifts and adds per sample, no multiply.
+ *
+ * Nibbles are packed low nibble first (the WAV/IMA convention). The codec
+ * state is small and explicit, so a stream can be cut into independently
+ * decodable packets by sending the state at the start of each packet.
+ */
+
+#ifndef ADPCM_H
+#define ADPCM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct AdpcmState {
+    int16_t predictor;          // Last reconstructed sample
+    uint8_t stepIndex;          // 0-88 into the IMA step table
+};
+
+void adpcmReset(AdpcmState& state);
+
+// Encode `count` samples (must be even) into count / 2 bytes
+void adpcmEncode(AdpcmState& state, const int16_t* samples, size_t count, uint8_t* out);
+
+// Decode `bytes` bytes into 2 * bytes samples
+void adpcmDecode(AdpcmState& state, const uint8_t* in, size_t bytes, int16_t* samples);
+
+#endif // ADPCM_H
@@ -0,0 +1,48 @@
+/**
+ * Block Automatic Gain Control
+ *
+ * Envelope and gain are computed once per block; the gain applied to the
+ * samples ramps linearly from the previous block's value to the new one,
+ * so there is no per-sample divide, exp() or zipper noise.
+ *
+ *   envelope  block peak, smoothed with separate attack/release
+ *             coefficients (Q15)
+ *   gain      target / envelope, limited to [minGain, maxGain] and to what
+ *             the block peak can take without clipping (Q12, 4096 = 1.0)
+ *
+ * While the VAD reports no voice the gain may fall but not rise, so pauses
+ * and background noise are not pumped up to speech level.
+ */
+
+#ifndef AGC_H
+#define AGC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define AGC_GAIN_ONE            4096    // Q12 unity gain
+
+struct AgcConfig {
+    uint16_t targetQ15;         // Desired envelope (peak) level
+    uint16_t attackMs;
+    uint16_t releaseMs;
+    uint16_t blockMs;           // Duration of one agcProcess() block
+    int32_t minGainQ12;
+    int32_t maxGainQ12;
+};
+
+struct Agc {
+    AgcConfig config;
+    uint16_t attackQ15;         // Per-block smoothing coefficients
+    uint16_t releaseQ15;
+    int32_t envelopeQ15;
+    int32_t gainQ12;            // Gain reached at the end of the last block
+};
+
+void agcInit(Agc& agc, const AgcConfig& config);
+void agcReset(Agc& agc);
+
+// Apply gain to one block in place
+void agcProcess(Agc& agc, int16_t* samples, size_t count, bool voice);
+
+#endif // AGC_H
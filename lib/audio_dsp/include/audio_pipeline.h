@@ -0,0 +1,127 @@
+/**
+ * Zero-Copy Audio Pipeline Building Blocks
+ *
+ *   source --> [frame from FramePool] --> stage --> stage --> sink(s)
+ *
+ * Frames come from a fixed pool allocated statically at build time; stages
+ * and sinks get a reference to the same frame and work on it in place, so
+ * after the source fills it no sample is copied again. A sink that needs a
+ * frame beyond the current pass (e.g. a transmit queue) retains it and
+ * releases it when done; the frame returns to the pool at the last release.
+ *
+ * Stages are plain classes with `void process(Frame&)`. Wrapping one in
+ * StageSlot<Enabled, Stage> makes it conditional at compile time: a
+ * disabled slot holds no state and its process() is an empty inline, so it
+ * costs neither RAM nor cycles.
+ *
+ * Header-only and hardware-independent.
+ */
+
+#ifndef AUDIO_PIPELINE_H
+#define AUDIO_PIPELINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// AudioFrame flags, set by the stages that know them
+#define AUDIO_FRAME_VOICE       0x01    // VAD: speech in this frame
+
+template <size_t Samples>
+struct AudioFrame {
+    static const size_t size = Samples;
+    int16_t samples[Samples];
+    uint32_t sequence;          // Source frame counter, for loss detection
+    uint8_t flags;              // AUDIO_FRAME_* bits
+};
+
+template <typename Frame, uint8_t Count>
+class FramePool {
+public:
+    FramePool() {
+        for (uint8_t i = 0; i < Count; i++) {
+            refs_[i] = 0;
+        }
+        lowWater_ = Count;
+    }
+
+    // Takes a free frame with one reference, or nullptr if all are in use.
+    // Safe against concurrent release() from other tasks.
+    Frame* acquire() {
+        for (uint8_t i = 0; i < Count; i++) {
+            uint8_t expected = 0;
+            if (__atomic_compare_exchange_n(&refs_[i], &expected, 1, false,
+                                            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                uint8_t free = available();
+                if (free < lowWater_) {
+                    lowWater_ = free;
+                }
+                frames_[i].flags = 0;
+                return &frames_[i];
+            }
+        }
+        exhausted_++;
+        return nullptr;
+    }
+
+    void retain(Frame* frame) {
+        __atomic_add_fetch(&refs_[indexOf(frame)], 1, __ATOMIC_RELAXED);
+    }
+
+    void release(Frame* frame) {
+        __atomic_sub_fetch(&refs_[indexOf(frame)], 1, __ATOMIC_RELEASE);
+    }
+
+    uint8_t available() const {
+        uint8_t free = 0;
+        for (uint8_t i = 0; i < Count; i++) {
+            free += __atomic_load_n(&refs_[i], __ATOMIC_RELAXED) == 0;
+        }
+        return free;
+    }
+
+    uint8_t lowWater() const { return lowWater_; }      // Fewest free frames seen
+    uint32_t exhausted() const { return exhausted_; }   // acquire() failures
+    static constexpr size_t bytes() { return sizeof(Frame) * Count; }
+
+private:
+    uint8_t indexOf(const Frame* frame) const {
+        return (uint8_t)(frame - frames_);
+    }
+
+    Frame frames_[Count];
+    uint8_t refs_[Count];
+    uint8_t lowWater_;
+    uint32_t exhausted_ = 0;
+};
+
+// Compile-time optional stage: holds the stage only when Enabled
+template <bool Enabled, typename Stage>
+struct StageSlot {
+    Stage stage;
+    static constexpr bool enabled = true;
+
+    template <typename Frame>
+    void process(Frame& frame) { stage.process(frame); }
+    Stage* get() { return &stage; }
+};
+
+template <typename Stage>
+struct StageSlot<false, Stage> {
+    static constexpr bool enabled = false;
+
+    template <typename Frame>
+    void process(Frame&) {}
+    Stage* get() { return nullptr; }
+};
+
+// Run a frame through stages and sinks in order
+template <typename Frame>
+inline void runStages(Frame&) {}
+
+template <typename Frame, typename First, typename... Rest>
+inline void runStages(Frame& frame, First& first, Rest&... rest) {
+    first.process(frame);
+    runStages(frame, rest...);
+}
+
+#endif // AUDIO_PIPELINE_H
@@ -0,0 +1,60 @@
+/**
+ * Fixed-Point Audio DSP Kernels
+ *
+ * The ESP32-C3 RISC-V core has no FPU, so every float multiply, divide and
+ * sqrt() is a soft-float library call. These kernels work directly on the
+ * int16 (Q15) samples from the I2S driver using integer accumulators.
+ *
+ * Formats used throughout:
+ *   Q15 - int16 sample, full scale = 1.0
+ *   Q30 - uint32 mean square of Q15 samples, full scale = 1.0
+ *
+ * Build with -DDSP_FIXED_POINT=0 to fall back to the float reference path
+ * for A/B comparison.
+ */
+
+#ifndef DSP_H
+#define DSP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef DSP_FIXED_POINT
+#define DSP_FIXED_POINT 1
+#endif
+
+// Sum of squared samples; 64-bit so a full-scale frame cannot overflow
+uint64_t dspSumSquares(const int16_t* samples, size_t count);
+
+// Mean square of a frame in Q30 (RMS^2 with full scale = 1 << 30)
+uint32_t dspMeanSquareQ30(const int16_t* samples, size_t count);
+
+// Integer square root, floor(sqrt(value))
+uint32_t dspIsqrt32(uint32_t value);
+
+// RMS of a frame in Q15 (isqrt of the Q30 mean square)
+int16_t dspRmsQ15(const int16_t* samples, size_t count);
+
+// Per-frame features, computed in a single pass over the samples
+struct DspFrameStats {
+    uint32_t meanSquareQ30;     // As dspMeanSquareQ30()
+    uint16_t zeroCrossings;     // Sign changes between adjacent samples
+};
+
+// Energy and zero-crossing count of a frame. With DSP_FIXED_POINT=0 the
+// float reference computes the same result for A/B comparison.
+DspFrameStats dspFrameStats(const int16_t* samples, size_t count);
+
+// Q15 constant from a float in [0, 1), folded at compile time
+constexpr uint16_t dspQ15(float value) {
+    return (uint16_t)(value * 32768.0f + 0.5f);
+}
+
+// Convert a linear RMS threshold (0.0 - 1.0) into the squared Q30 domain so
+// comparisons against dspMeanSquareQ30() need no root. Usable in constant
+// expressions so thresholds are folded at compile time.
+constexpr uint32_t dspThresholdQ30(float rms) {
+    return (uint32_t)((double)rms * (double)rms * (double)(1UL << 30));
+}
+
+#endif // DSP_H
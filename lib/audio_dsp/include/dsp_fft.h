@@ -0,0 +1,42 @@
+/**
+ * Fixed-Point Real FFT
+ *
+ * 512-point real FFT on int32 data with Q15 twiddles. The real signal is
+ * packed into a 256-point complex FFT and split afterwards, which halves
+ * the butterfly count compared with transforming a zero imaginary part.
+ * Twiddles come from a 129-entry quarter-wave sine table in flash.
+ *
+ * Scaling: the forward transform is unscaled, so int16-range input grows
+ * to at most 2^24 per bin. The inverse divides by 2 per stage (1/N in
+ * total), which keeps intermediate values inside int32 without a separate
+ * normalization pass.
+ */
+
+#ifndef DSP_FFT_H
+#define DSP_FFT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define DSP_FFT_SIZE            512
+#define DSP_FFT_BINS            (DSP_FFT_SIZE / 2 + 1)
+
+struct DspComplex {
+    int32_t re;
+    int32_t im;
+};
+
+// sin(2*pi*index/512) in Q15, any index (wraps)
+int16_t dspSinQ15(uint32_t index);
+inline int16_t dspCosQ15(uint32_t index) {
+    return dspSinQ15(index + DSP_FFT_SIZE / 4);
+}
+
+// Forward transform of DSP_FFT_SIZE real samples into DSP_FFT_BINS bins
+// (DC .. Nyquist). `spectrum` doubles as the work buffer.
+void dspRealFft(const int32_t* input, DspComplex* spectrum);
+
+// Inverse of dspRealFft(). `spectrum` is overwritten.
+void dspRealIfft(DspComplex* spectrum, int32_t* output);
+
+#endif // DSP_FFT_H
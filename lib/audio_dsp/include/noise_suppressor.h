@@ -0,0 +1,57 @@
+/**
+ * Spectral-Subtraction Noise Suppressor
+ *
+ * Works on 10 ms hops (NS_HOP samples at 16 kHz) with 50 % overlap-add:
+ * each call windows the previous and the current hop (320 samples,
+ * sqrt-Hann), zero-pads to the 512-point real FFT, scales every bin by a
+ * spectral-subtraction gain and overlap-adds the inverse. Analysis and
+ * synthesis windows multiply to a Hann window, so an all-pass gain
+ * reconstructs the input exactly, delayed by one hop.
+ *
+ * The per-bin noise magnitude is learnt only from frames the VAD marks as
+ * non-speech. Gain per bin:
+ *
+ *   G = max(1 - strength * noise / |X|, floor)
+ *
+ * Tables (window, twiddles) are const and live in flash. The FFT scratch
+ * buffers are shared, so only one suppressor may run at a time.
+ */
+
+#ifndef NOISE_SUPPRESSOR_H
+#define NOISE_SUPPRESSOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "dsp_fft.h"
+
+#define NS_HOP                  160     // Samples per call (one 10 ms frame)
+#define NS_WINDOW               (2 * NS_HOP)
+
+struct NoiseSuppressorConfig {
+    bool enabled;               // false: frames pass through untouched
+    uint16_t floorQ15;          // Minimum gain per bin
+    uint16_t noiseAlphaQ15;     // Noise estimate memory per frame
+};
+
+struct NoiseSuppressor {
+    NoiseSuppressorConfig config;
+    uint16_t strengthQ8;        // Over-subtraction factor, 0 - 2.0
+    uint16_t noiseFrames;       // Frames learnt since reset (saturates)
+    int16_t previous[NS_HOP];   // Last input hop, first half of the window
+    int32_t overlap[NS_HOP];    // Synthesis tail for the next output hop
+    uint32_t noiseMag[DSP_FFT_BINS];
+};
+
+void nsInit(NoiseSuppressor& ns, const NoiseSuppressorConfig& config);
+
+// Forget the noise estimate and the overlap state
+void nsReset(NoiseSuppressor& ns);
+
+// Suppression strength, 0-100 % (100 % subtracts twice the noise estimate)
+void nsSetLevel(NoiseSuppressor& ns, uint8_t percent);
+
+// Process one hop. `voice` is the VAD decision for this frame; the noise
+// estimate is only updated while it is false. `in` and `out` may alias.
+void nsProcess(NoiseSuppressor& ns, const int16_t* in, int16_t* out, bool voice);
+
+#endif // NOISE_SUPPRESSOR_H
@@ -0,0 +1,80 @@
+/**
+ * Streaming Voice Activity Detector
+ *
+ * Per 10 ms frame the detector does O(1) work on top of one pass over the
+ * samples (dspFrameStats):
+ *
+ *  - short-term energy: running sum of the last VAD_WINDOW_FRAMES frame
+ *    energies, updated by adding the newest and subtracting the oldest
+ *  - adaptive noise floor: follows the energy down quickly and up slowly,
+ *    and only learns from frames that are not speech
+ *  - minimum tracking: the lowest short-term energy over the last
+ *    VAD_MIN_BLOCKS blocks of minBlockFrames. The floor never stays below
+ *    it, in any state. A step up in background noise that keeps the
+ *    detector open (fan, wind, traffic) therefore raises the floor once
+ *    the quieter past has left the window, and voice closes again.
+ *    Speech always has pauses that hold the minimum down.
+ *  - zero-crossing rate: rejects broadband noise (fans, hiss, keyboard
+ *    clicks) that is loud but crosses zero far more often than voice
+ *
+ * A frame is a speech candidate when the short-term energy is above both
+ * the absolute threshold and the noise floor times the margin, and the ZCR
+ * is below the limit. Voice opens after triggerFrames consecutive
+ * candidates and closes hangoverFrames after the last one.
+ *
+ * All state lives in a Vad object; nothing here touches hardware.
+ */
+
+#ifndef VAD_H
+#define VAD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "dsp.h"
+
+#define VAD_WINDOW_FRAMES       10
+#define VAD_MIN_BLOCKS          8
+
+struct VadConfig {
+    uint32_t thresholdQ30;      // Absolute energy threshold (RMS^2, Q30)
+    uint16_t noiseMarginQ8;     // Energy must exceed floor * margin (Q8)
+    uint16_t energyAlphaQ15;    // Noise floor weight when energy drops
+    uint16_t floorAlphaQ15;     // Noise floor memory when energy rises
+    uint16_t zcrLimit;          // Max zero crossings per frame for speech
+    uint16_t triggerFrames;     // Consecutive candidates to open
+    uint16_t hangoverFrames;    // Frames held open after the last candidate
+    uint16_t minBlockFrames;    // Frames per minimum-tracking block
+};
+
+struct Vad {
+    VadConfig config;
+    uint32_t history[VAD_WINDOW_FRAMES];
+    uint64_t energySum;         // Sum of history[]
+    uint8_t index;
+    uint32_t noiseFloorQ30;
+    uint32_t minBlocks[VAD_MIN_BLOCKS];     // Minimum of each completed block
+    uint32_t minCurrent;        // Minimum of the block being filled
+    uint32_t minTracked;        // Minimum over minBlocks[]
+    uint16_t minFrames;         // Frames in the current block
+    uint8_t minIndex;
+    uint16_t candidateRun;
+    uint16_t hangover;
+    bool voice;
+    DspFrameStats lastFrame;
+};
+
+void vadInit(Vad& vad, const VadConfig& config);
+
+// Clear history and state, e.g. when capture restarts
+void vadReset(Vad& vad);
+
+void vadSetThreshold(Vad& vad, uint32_t thresholdQ30);
+
+// Feed one frame; returns the voice decision after it
+bool vadProcess(Vad& vad, const int16_t* frame, size_t count);
+
+// Mean short-term energy and noise floor (Q30), for diagnostics
+uint32_t vadEnergyQ30(const Vad& vad);
+uint32_t vadNoiseFloorQ30(const Vad& vad);
+
+#endif // VAD_H
@@ -0,0 +1,74 @@
+/**
+ * IMA-ADPCM Codec - see adpcm.h
+ */
+
+#include "adpcm.h"
+
+static const int16_t stepTable[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t indexTable[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+static inline int16_t saturate16(int32_t v) {
+    return v > 32767 ? 32767 : (v < -32768 ? -32768 : (int16_t)v);
+}
+
+// Apply one code to the state; shared by encoder and decoder so both
+// reconstruct exactly the same predictor
+static inline void advance(AdpcmState& state, uint8_t code) {
+    int32_t step = stepTable[state.stepIndex];
+    int32_t delta = step >> 3;
+    if (code & 4) delta += step;
+    if (code & 2) delta += step >> 1;
+    if (code & 1) delta += step >> 2;
+    state.predictor = saturate16(state.predictor + ((code & 8) ? -delta : delta));
+
+    int32_t index = state.stepIndex + indexTable[code & 7];
+    state.stepIndex = (uint8_t)(index < 0 ? 0 : (index > 88 ? 88 : index));
+}
+
+static inline uint8_t encodeSample(AdpcmState& state, int16_t sample) {
+    int32_t step = stepTable[state.stepIndex];
+    int32_t diff = (int32_t)sample - state.predictor;
+    uint8_t code = 0;
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+    if (diff >= step) { code |= 4; diff -= step; }
+    step >>= 1;
+    if (diff >= step) { code |= 2; diff -= step; }
+    step >>= 1;
+    if (diff >= step) { code |= 1; }
+
+    advance(state, code);
+    return code;
+}
+
+void adpcmReset(AdpcmState& state) {
+    state.predictor = 0;
+    state.stepIndex = 0;
+}
+
+void adpcmEncode(AdpcmState& state, const int16_t* samples, size_t count, uint8_t* out) {
+    for (size_t i = 0; i + 1 < count; i += 2) {
+        uint8_t low = encodeSample(state, samples[i]);
+        uint8_t high = encodeSample(state, samples[i + 1]);
+        *out++ = (uint8_t)(low | (high << 4));
+    }
+}
+
+void adpcmDecode(AdpcmState& state, const uint8_t* in, size_t bytes, int16_t* samples) {
+    for (size_t i = 0; i < bytes; i++) {
+        advance(state, in[i] & 0x0F);
+        *samples++ = state.predictor;
+        advance(state, in[i] >> 4);
+        *samples++ = state.predictor;
+    }
+}
@@ -0,0 +1,83 @@
+/**
+ * Block Automatic Gain Control - see agc.h
+ */
+
+#include "agc.h"
+#include <math.h>
+
+// One-pole coefficient for a time constant, in Q15. Called at init only.
+static uint16_t blockCoefficient(uint16_t tauMs, uint16_t blockMs) {
+    if (tauMs == 0) {
+        return 32767;
+    }
+    float alpha = 1.0f - expf(-(float)blockMs / (float)tauMs);
+    return (uint16_t)(alpha * 32767.0f + 0.5f);
+}
+
+static inline int16_t saturate16(int32_t v) {
+    return v > 32767 ? 32767 : (v < -32768 ? -32768 : (int16_t)v);
+}
+
+void agcInit(Agc& agc, const AgcConfig& config) {
+    agc.config = config;
+    agc.attackQ15 = blockCoefficient(config.attackMs, config.blockMs);
+    agc.releaseQ15 = blockCoefficient(config.releaseMs, config.blockMs);
+    agcReset(agc);
+}
+
+void agcReset(Agc& agc) {
+    agc.envelopeQ15 = 0;
+    agc.gainQ12 = AGC_GAIN_ONE;
+}
+
+void agcProcess(Agc& agc, int16_t* samples, size_t count, bool voice) {
+    if (count == 0) {
+        return;
+    }
+    const AgcConfig& cfg = agc.config;
+
+    int32_t peak = 0;
+    for (size_t i = 0; i < count; i++) {
+        int32_t s = samples[i];
+        int32_t a = s < 0 ? -s : s;
+        if (a > peak) {
+            peak = a;
+        }
+    }
+
+    int32_t delta = peak - agc.envelopeQ15;
+    uint16_t coeff = delta > 0 ? agc.attackQ15 : agc.releaseQ15;
+    agc.envelopeQ15 += (delta * coeff) >> 15;
+
+    // One divide per block for the new gain
+    int32_t target = cfg.maxGainQ12;
+    if (agc.envelopeQ15 > 0) {
+        target = (int32_t)(((int64_t)cfg.targetQ15 << 12) / agc.envelopeQ15);
+    }
+    if (peak > 0) {
+        int32_t headroom = (int32_t)((32767LL << 12) / peak);
+        if (target > headroom) {
+            target = headroom;
+        }
+    }
+    if (!voice && target > agc.gainQ12) {
+        target = agc.gainQ12;
+    }
+    target = target < cfg.minGainQ12 ? cfg.minGainQ12
+           : (target > cfg.maxGainQ12 ? cfg.maxGainQ12 : target);
+
+    // A block that would clip at the old gain gets the new one at once
+    if ((int64_t)peak * agc.gainQ12 > (32767LL << 12)) {
+        agc.gainQ12 = target;
+    }
+
+    // Ramp from the previous gain to the new one across the block; the
+    // step carries 8 extra fraction bits
+    int32_t gain = agc.gainQ12 << 8;
+    int32_t step = ((target - agc.gainQ12) << 8) / (int32_t)count;
+    for (size_t i = 0; i < count; i++) {
+        gain += step;
+        samples[i] = saturate16((samples[i] * (gain >> 8)) >> 12);
+    }
+    agc.gainQ12 = target;
+}
@@ -0,0 +1,89 @@
+/**
+ * Fixed-Point Audio DSP Kernels - see dsp.h
+ */
+
+#include "dsp.h"
+
+uint64_t dspSumSquares(const int16_t* samples, size_t count) {
+    // Two 32-bit partial sums per iteration: each product is below 2^30, so
+    // a pair of them fits in uint32 and the 64-bit add happens half as often
+    uint64_t sum = 0;
+    size_t i = 0;
+    for (; i + 1 < count; i += 2) {
+        int32_t a = samples[i];
+        int32_t b = samples[i + 1];
+        sum += (uint32_t)(a * a) + (uint32_t)(b * b);
+    }
+    if (i < count) {
+        int32_t a = samples[i];
+        sum += (uint32_t)(a * a);
+    }
+    return sum;
+}
+
+uint32_t dspMeanSquareQ30(const int16_t* samples, size_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    // Q15 * Q15 = Q30 per sample; the mean stays at or below 2^30
+    return (uint32_t)(dspSumSquares(samples, count) / count);
+}
+
+DspFrameStats dspFrameStats(const int16_t* samples, size_t count) {
+    DspFrameStats stats = { 0, 0 };
+    if (count == 0) {
+        return stats;
+    }
+
+#if DSP_FIXED_POINT
+    uint64_t sum = 0;
+    uint16_t crossings = 0;
+    int32_t prev = samples[0];
+    sum += (uint32_t)(prev * prev);
+    for (size_t i = 1; i < count; i++) {
+        int32_t s = samples[i];
+        sum += (uint32_t)(s * s);
+        crossings += (uint16_t)((s ^ prev) < 0);    // Sign bits differ
+        prev = s;
+    }
+    stats.meanSquareQ30 = (uint32_t)(sum / count);
+    stats.zeroCrossings = crossings;
+#else
+    float energy = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        float s = samples[i] / 32768.0f;
+        energy += s * s;
+        if (i > 0 && (samples[i] < 0) != (samples[i - 1] < 0)) {
+            stats.zeroCrossings++;
+        }
+    }
+    stats.meanSquareQ30 = (uint32_t)(energy / count * (float)(1UL << 30));
+#endif
+    return stats;
+}
+
+uint32_t dspIsqrt32(uint32_t value) {
+    // Bit-by-bit method: 16 iterations of shift/compare/subtract
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+int16_t dspRmsQ15(const int16_t* samples, size_t count) {
+    uint32_t root = dspIsqrt32(dspMeanSquareQ30(samples, count));
+    // sqrt(2^30) = 2^15 only for a full-scale square wave; clamp to Q15 max
+    return root > 32767 ? 32767 : (int16_t)root;
+}
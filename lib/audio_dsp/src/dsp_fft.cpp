@@ -0,0 +1,173 @@
+/**
+ * Fixed-Point Real FFT - see dsp_fft.h
+ */
+
+#include "dsp_fft.h"
+
+#define HALF_SIZE               (DSP_FFT_SIZE / 2)      // Complex FFT length
+#define HALF_LOG2               8
+
+// sin(2*pi*i/512), i = 0..128, Q15 (1.0 clipped to 32767)
+static const int16_t quarterSine[DSP_FFT_SIZE / 4 + 1] = {
+        0,   402,   804,  1206,  1608,  2009,  2411,  2811,  3212,  3612,  4011,  4410,
+     4808,  5205,  5602,  5998,  6393,  6787,  7180,  7571,  7962,  8351,  8740,  9127,
+     9512,  9896, 10279, 10660, 11039, 11417, 11793, 12167, 12540, 12910, 13279, 13646,
+    14010, 14373, 14733, 15091, 15447, 15800, 16151, 16500, 16846, 17190, 17531, 17869,
+    18205, 18538, 18868, 19195, 19520, 19841, 20160, 20475, 20788, 21097, 21403, 21706,
+    22006, 22302, 22595, 22884, 23170, 23453, 23732, 24008, 24279, 24548, 24812, 25073,
+    25330, 25583, 25833, 26078, 26320, 26557, 26791, 27020, 27246, 27467, 27684, 27897,
+    28106, 28311, 28511, 28707, 28899, 29086, 29269, 29448, 29622, 29792, 29957, 30118,
+    30274, 30425, 30572, 30715, 30853, 30986, 31114, 31238, 31357, 31471, 31581, 31686,
+    31786, 31881, 31972, 32058, 32138, 32214, 32286, 32352, 32413, 32470, 32522, 32568,
+    32610, 32647, 32679, 32706, 32729, 32746, 32758, 32766, 32767,
+};
+
+int16_t dspSinQ15(uint32_t index) {
+    index &= DSP_FFT_SIZE - 1;
+    const uint32_t quarter = DSP_FFT_SIZE / 4;
+    if (index <= quarter) {
+        return quarterSine[index];
+    }
+    if (index <= 2 * quarter) {
+        return quarterSine[2 * quarter - index];
+    }
+    if (index <= 3 * quarter) {
+        return (int16_t)-quarterSine[index - 2 * quarter];
+    }
+    return (int16_t)-quarterSine[4 * quarter - index];
+}
+
+static inline int32_t mulQ15(int32_t a, int32_t b) {
+    return (int32_t)(((int64_t)a * b) >> 15);
+}
+
+static void bitReverse(DspComplex* z) {
+    for (uint32_t i = 0, j = 0; i < HALF_SIZE; i++) {
+        if (i < j) {
+            DspComplex t = z[i];
+            z[i] = z[j];
+            z[j] = t;
+        }
+        uint32_t bit = HALF_SIZE >> 1;
+        while (j & bit) {
+            j ^= bit;
+            bit >>= 1;
+        }
+        j |= bit;
+    }
+}
+
+// In-place radix-2 DIT complex FFT of HALF_SIZE points. With `scale` every
+// stage halves its outputs (used by the inverse).
+static void complexFft(DspComplex* z, bool scale) {
+    const int shift = scale ? 1 : 0;
+    bitReverse(z);
+
+    // First stage: twiddle is 1, no multiplies
+    for (uint32_t i = 0; i < HALF_SIZE; i += 2) {
+        DspComplex a = z[i];
+        DspComplex b = z[i + 1];
+        z[i].re = (a.re + b.re) >> shift;
+        z[i].im = (a.im + b.im) >> shift;
+        z[i + 1].re = (a.re - b.re) >> shift;
+        z[i + 1].im = (a.im - b.im) >> shift;
+    }
+
+    for (uint32_t len = 4; len <= HALF_SIZE; len <<= 1) {
+        uint32_t half = len >> 1;
+        uint32_t step = DSP_FFT_SIZE / len;     // Index step in the 512 circle
+        for (uint32_t k = 0; k < half; k++) {
+            int32_t c = dspCosQ15(k * step);
+            int32_t s = dspSinQ15(k * step);
+            for (uint32_t i = k; i < HALF_SIZE; i += len) {
+                DspComplex& a = z[i];
+                DspComplex& b = z[i + half];
+                // t = b * (c - js)
+                int32_t tr = mulQ15(b.re, c) + mulQ15(b.im, s);
+                int32_t ti = mulQ15(b.im, c) - mulQ15(b.re, s);
+                b.re = (a.re - tr) >> shift;
+                b.im = (a.im - ti) >> shift;
+                a.re = (a.re + tr) >> shift;
+                a.im = (a.im + ti) >> shift;
+            }
+        }
+    }
+}
+
+void dspRealFft(const int32_t* input, DspComplex* spectrum) {
+    // Even samples in the real part, odd samples in the imaginary part
+    for (uint32_t n = 0; n < HALF_SIZE; n++) {
+        spectrum[n].re = input[2 * n];
+        spectrum[n].im = input[2 * n + 1];
+    }
+    complexFft(spectrum, false);
+
+    // Split Z into the even/odd spectra and combine: X[k] = Fe + W^k Fo,
+    // X[N/2-k] = conj(Fe - W^k Fo). Bins k and N/2-k are done together.
+    DspComplex z0 = spectrum[0];
+    spectrum[0].re = z0.re + z0.im;
+    spectrum[0].im = 0;
+    spectrum[HALF_SIZE].re = z0.re - z0.im;
+    spectrum[HALF_SIZE].im = 0;
+    spectrum[HALF_SIZE / 2].im = -spectrum[HALF_SIZE / 2].im;
+
+    for (uint32_t k = 1; k < HALF_SIZE / 2; k++) {
+        DspComplex a = spectrum[k];
+        DspComplex b = spectrum[HALF_SIZE - k];
+        int32_t feRe = (a.re + b.re) >> 1;
+        int32_t feIm = (a.im - b.im) >> 1;
+        int32_t foRe = (a.im + b.im) >> 1;
+        int32_t foIm = (b.re - a.re) >> 1;
+
+        int32_t c = dspCosQ15(k);
+        int32_t s = dspSinQ15(k);
+        int32_t tRe = mulQ15(foRe, c) + mulQ15(foIm, s);
+        int32_t tIm = mulQ15(foIm, c) - mulQ15(foRe, s);
+
+        spectrum[k].re = feRe + tRe;
+        spectrum[k].im = feIm + tIm;
+        spectrum[HALF_SIZE - k].re = feRe - tRe;
+        spectrum[HALF_SIZE - k].im = tIm - feIm;
+    }
+}
+
+void dspRealIfft(DspComplex* spectrum, int32_t* output) {
+    // Undo the split: Fe = (X[k] + conj X[N/2-k]) / 2,
+    // Fo = (X[k] - conj X[N/2-k]) / 2 * W^-k, Z[k] = Fe + j Fo
+    int32_t x0 = spectrum[0].re;
+    int32_t xn = spectrum[HALF_SIZE].re;
+    spectrum[0].re = (x0 + xn) >> 1;
+    spectrum[0].im = (x0 - xn) >> 1;
+    spectrum[HALF_SIZE / 2].im = -spectrum[HALF_SIZE / 2].im;
+
+    for (uint32_t k = 1; k < HALF_SIZE / 2; k++) {
+        DspComplex a = spectrum[k];
+        DspComplex b = spectrum[HALF_SIZE - k];
+        int32_t feRe = (a.re + b.re) >> 1;
+        int32_t feIm = (a.im - b.im) >> 1;
+        int32_t dRe = (a.re - b.re) >> 1;
+        int32_t dIm = (a.im + b.im) >> 1;
+
+        // Fo = d * (c + js)
+        int32_t c = dspCosQ15(k);
+        int32_t s = dspSinQ15(k);
+        int32_t foRe = mulQ15(dRe, c) - mulQ15(dIm, s);
+        int32_t foIm = mulQ15(dIm, c) + mulQ15(dRe, s);
+
+        // Z[k] = Fe + j Fo, Z[N/2-k] = conj(Fe) + j conj(Fo)
+        spectrum[k].re = feRe - foIm;
+        spectrum[k].im = feIm + foRe;
+        spectrum[HALF_SIZE - k].re = feRe + foIm;
+        spectrum[HALF_SIZE - k].im = foRe - feIm;
+    }
+
+    // IFFT(Z) = conj(FFT(conj(Z))) / N; the scaled stages supply the 1/N
+    for (uint32_t n = 0; n < HALF_SIZE; n++) {
+        spectrum[n].im = -spectrum[n].im;
+    }
+    complexFft(spectrum, true);
+    for (uint32_t n = 0; n < HALF_SIZE; n++) {
+        output[2 * n] = spectrum[n].re;
+        output[2 * n + 1] = -spectrum[n].im;
+    }
+}
@@ -0,0 +1,147 @@
+/**
+ * Spectral-Subtraction Noise Suppressor - see noise_suppressor.h
+ */
+
+#include "noise_suppressor.h"
+#include <string.h>
+
+// sqrt-Hann, first half: sin(pi * (n + 0.5) / 320), Q15. The second half
+// is the mirror image.
+static const int16_t halfWindow[NS_HOP] = {
+      161,   483,   804,  1126,  1447,  1768,  2090,  2411,  2731,  3052,  3372,  3692,
+     4011,  4330,  4649,  4967,  5285,  5602,  5919,  6235,  6550,  6865,  7180,  7493,
+     7806,  8118,  8429,  8740,  9049,  9358,  9666,  9973, 10279, 10584, 10888, 11191,
+    11492, 11793, 12093, 12391, 12688, 12984, 13279, 13572, 13865, 14155, 14445, 14733,
+    15019, 15305, 15588, 15871, 16151, 16430, 16708, 16984, 17258, 17531, 17802, 18071,
+    18338, 18604, 18868, 19130, 19390, 19649, 19905, 20160, 20413, 20663, 20912, 21159,
+    21403, 21646, 21886, 22125, 22361, 22595, 22827, 23056, 23284, 23509, 23732, 23953,
+    24171, 24387, 24601, 24812, 25021, 25228, 25432, 25633, 25833, 26029, 26223, 26415,
+    26604, 26791, 26975, 27156, 27335, 27511, 27684, 27855, 28023, 28188, 28351, 28511,
+    28668, 28823, 28974, 29123, 29269, 29412, 29553, 29690, 29825, 29957, 30086, 30212,
+    30335, 30455, 30572, 30687, 30798, 30906, 31012, 31114, 31214, 31310, 31403, 31494,
+    31581, 31665, 31747, 31825, 31900, 31972, 32041, 32107, 32169, 32229, 32286, 32339,
+    32389, 32437, 32481, 32522, 32559, 32594, 32626, 32654, 32679, 32701, 32720, 32736,
+    32749, 32758, 32764, 32767,
+};
+
+// Shared FFT scratch (see header)
+static int32_t timeBuf[DSP_FFT_SIZE];
+static DspComplex spectrum[DSP_FFT_BINS];
+
+static inline int32_t windowAt(uint32_t n) {
+    return n < NS_HOP ? halfWindow[n] : halfWindow[NS_WINDOW - 1 - n];
+}
+
+static inline int16_t saturate16(int32_t v) {
+    return v > 32767 ? 32767 : (v < -32768 ? -32768 : (int16_t)v);
+}
+
+// |X| by alpha-max-plus-beta-min (max + 3/8 min, within 7 %), no sqrt
+static inline uint32_t magnitude(const DspComplex& x) {
+    uint32_t a = x.re < 0 ? -(uint32_t)x.re : (uint32_t)x.re;
+    uint32_t b = x.im < 0 ? -(uint32_t)x.im : (uint32_t)x.im;
+    uint32_t hi = a > b ? a : b;
+    uint32_t lo = a > b ? b : a;
+    return hi + (lo >> 2) + (lo >> 3);
+}
+
+static inline uint32_t bitLength(uint32_t v) {
+    return v ? 32 - __builtin_clz(v) : 0;
+}
+
+// Spectral-subtraction gain for one bin, Q15 (32768 = unity)
+static uint32_t binGain(const NoiseSuppressor& ns, uint32_t mag, uint32_t noise) {
+    if (mag == 0) {
+        return ns.config.floorQ15;
+    }
+    // Normalize both to 16 bits so the Q15 ratio is a 32-bit divide
+    uint32_t shift = bitLength(mag) > 16 ? bitLength(mag) - 16 : 0;
+    uint32_t x = mag >> shift;
+    uint32_t n = noise >> shift;
+    if (n >= 2 * x) {
+        return ns.config.floorQ15;  // Ratio >= 2: below the floor for any strength
+    }
+    uint32_t ratioQ15 = (n << 15) / x;
+    uint32_t sub = (ratioQ15 * ns.strengthQ8) >> 8;
+    if (sub >= 32768u - ns.config.floorQ15) {
+        return ns.config.floorQ15;
+    }
+    return 32768u - sub;
+}
+
+void nsInit(NoiseSuppressor& ns, const NoiseSuppressorConfig& config) {
+    ns.config = config;
+    ns.strengthQ8 = 256;
+    nsReset(ns);
+}
+
+void nsReset(NoiseSuppressor& ns) {
+    ns.noiseFrames = 0;
+    memset(ns.previous, 0, sizeof(ns.previous));
+    memset(ns.overlap, 0, sizeof(ns.overlap));
+    memset(ns.noiseMag, 0, sizeof(ns.noiseMag));
+}
+
+void nsSetLevel(NoiseSuppressor& ns, uint8_t percent) {
+    if (percent > 100) {
+        percent = 100;
+    }
+    ns.strengthQ8 = (uint16_t)(percent * 512 / 100);
+}
+
+void nsProcess(NoiseSuppressor& ns, const int16_t* in, int16_t* out, bool voice) {
+    if (!ns.config.enabled) {
+        if (out != in) {
+            memcpy(out, in, NS_HOP * sizeof(int16_t));
+        }
+        return;
+    }
+
+    // Analysis window over [previous hop | current hop], zero padded
+    for (uint32_t n = 0; n < NS_HOP; n++) {
+        timeBuf[n] = ((int32_t)ns.previous[n] * windowAt(n)) >> 15;
+        timeBuf[n + NS_HOP] = ((int32_t)in[n] * windowAt(n + NS_HOP)) >> 15;
+    }
+    memset(&timeBuf[NS_WINDOW], 0, (DSP_FFT_SIZE - NS_WINDOW) * sizeof(int32_t));
+    memcpy(ns.previous, in, sizeof(ns.previous));
+
+    dspRealFft(timeBuf, spectrum);
+
+    bool learn = !voice;
+    bool suppress = ns.noiseFrames > 0 && ns.strengthQ8 > 0;
+    uint32_t keep = ns.config.noiseAlphaQ15;
+
+    for (uint32_t k = 0; k < DSP_FFT_BINS; k++) {
+        uint32_t mag = magnitude(spectrum[k]);
+
+        if (learn) {
+            uint32_t& noise = ns.noiseMag[k];
+            if (ns.noiseFrames == 0) {
+                noise = mag;
+            } else {
+                int64_t delta = (int64_t)mag - noise;
+                noise = (uint32_t)((int64_t)noise + ((delta * (32768 - keep)) >> 15));
+            }
+        }
+
+        if (suppress) {
+            int32_t g = (int32_t)binGain(ns, mag, ns.noiseMag[k]);
+            spectrum[k].re = (int32_t)(((int64_t)spectrum[k].re * g) >> 15);
+            spectrum[k].im = (int32_t)(((int64_t)spectrum[k].im * g) >> 15);
+        }
+    }
+    if (learn && ns.noiseFrames < UINT16_MAX) {
+        ns.noiseFrames++;
+    }
+
+    dspRealIfft(spectrum, timeBuf);
+
+    // Synthesis window and overlap-add; samples past NS_WINDOW are the
+    // circular tail of the gain filter and are dropped
+    for (uint32_t n = 0; n < NS_HOP; n++) {
+        int32_t head = (int32_t)(((int64_t)timeBuf[n] * windowAt(n)) >> 15);
+        int32_t tail = (int32_t)(((int64_t)timeBuf[n + NS_HOP] * windowAt(n + NS_HOP)) >> 15);
+        out[n] = saturate16(ns.overlap[n] + head);
+        ns.overlap[n] = tail;
+    }
+}
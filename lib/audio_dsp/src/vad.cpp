@@ -0,0 +1,130 @@
+/**
+ * Streaming Voice Activity Detector - see vad.h
+ */
+
+#include "vad.h"
+#include <string.h>
+
+#define VAD_MIN_NONE            UINT32_MAX
+
+void vadInit(Vad& vad, const VadConfig& config) {
+    vad.config = config;
+    vadReset(vad);
+}
+
+void vadReset(Vad& vad) {
+    memset(vad.history, 0, sizeof(vad.history));
+    vad.energySum = 0;
+    vad.index = 0;
+    vad.noiseFloorQ30 = 0;
+    for (uint8_t i = 0; i < VAD_MIN_BLOCKS; i++) {
+        vad.minBlocks[i] = VAD_MIN_NONE;
+    }
+    vad.minCurrent = VAD_MIN_NONE;
+    vad.minTracked = VAD_MIN_NONE;
+    vad.minFrames = 0;
+    vad.minIndex = 0;
+    vad.candidateRun = 0;
+    vad.hangover = 0;
+    vad.voice = false;
+    vad.lastFrame = DspFrameStats{ 0, 0 };
+}
+
+void vadSetThreshold(Vad& vad, uint32_t thresholdQ30) {
+    vad.config.thresholdQ30 = thresholdQ30;
+}
+
+static void updateNoiseFloor(Vad& vad, uint32_t energy) {
+    // One-pole filter: falls fast toward quieter frames, rises slowly so
+    // speech onsets are not absorbed into the floor
+    if (vad.noiseFloorQ30 == 0) {
+        vad.noiseFloorQ30 = energy;     // First frame after a reset
+        return;
+    }
+    int64_t floor = vad.noiseFloorQ30;
+    int64_t delta = (int64_t)energy - floor;
+    uint16_t alpha = delta < 0 ? vad.config.energyAlphaQ15
+                               : (uint16_t)(32768 - vad.config.floorAlphaQ15);
+    vad.noiseFloorQ30 = (uint32_t)(floor + ((delta * alpha) >> 15));
+}
+
+// Block-wise running minimum: one compare per frame, a pass over the
+// blocks only when one completes
+static void trackMinimum(Vad& vad, uint32_t energy) {
+    if (energy < vad.minCurrent) {
+        vad.minCurrent = energy;
+    }
+    if (++vad.minFrames < vad.config.minBlockFrames) {
+        return;
+    }
+    vad.minBlocks[vad.minIndex] = vad.minCurrent;
+    vad.minIndex = (vad.minIndex + 1) % VAD_MIN_BLOCKS;
+    vad.minCurrent = VAD_MIN_NONE;
+    vad.minFrames = 0;
+
+    uint32_t tracked = VAD_MIN_NONE;
+    for (uint8_t i = 0; i < VAD_MIN_BLOCKS; i++) {
+        if (vad.minBlocks[i] < tracked) {
+            tracked = vad.minBlocks[i];
+        }
+    }
+    vad.minTracked = tracked;
+}
+
+bool vadProcess(Vad& vad, const int16_t* frame, size_t count) {
+    const VadConfig& cfg = vad.config;
+    DspFrameStats stats = dspFrameStats(frame, count);
+    vad.lastFrame = stats;
+
+    // Running window sum: add the newest frame, drop the oldest
+    vad.energySum += stats.meanSquareQ30;
+    vad.energySum -= vad.history[vad.index];
+    vad.history[vad.index] = stats.meanSquareQ30;
+    vad.index = (vad.index + 1) % VAD_WINDOW_FRAMES;
+
+    // Compare sums against thresholds scaled by the window length, so no
+    // divide is needed on the hot path
+    uint64_t floorSum = ((uint64_t)vad.noiseFloorQ30 * VAD_WINDOW_FRAMES * cfg.noiseMarginQ8) >> 8;
+    bool candidate = vad.energySum > (uint64_t)cfg.thresholdQ30 * VAD_WINDOW_FRAMES &&
+                     vad.energySum > floorSum &&
+                     stats.zeroCrossings <= cfg.zcrLimit;
+
+    if (candidate) {
+        if (vad.candidateRun < cfg.triggerFrames) {
+            vad.candidateRun++;
+        }
+        if (vad.candidateRun >= cfg.triggerFrames) {
+            vad.voice = true;
+            vad.hangover = cfg.hangoverFrames;
+        }
+    } else {
+        vad.candidateRun = 0;
+        if (vad.hangover > 0) {
+            vad.hangover--;
+        } else {
+            vad.voice = false;
+        }
+    }
+
+    // The floor only learns from frames that are not speech, including
+    // onset frames still waiting for the trigger
+    uint32_t energy = vadEnergyQ30(vad);
+    if (!vad.voice && !candidate) {
+        updateNoiseFloor(vad, energy);
+    }
+    // ...but never stays below the recent minimum, or a louder background
+    // that looks like speech would hold the detector open for good
+    trackMinimum(vad, energy);
+    if (vad.minTracked != VAD_MIN_NONE && vad.minTracked > vad.noiseFloorQ30) {
+        vad.noiseFloorQ30 = vad.minTracked;
+    }
+    return vad.voice;
+}
+
+uint32_t vadEnergyQ30(const Vad& vad) {
+    return (uint32_t)(vad.energySum / VAD_WINDOW_FRAMES);
+}
+
+uint32_t vadNoiseFloorQ30(const Vad& vad) {
+    return vad.noiseFloorQ30;
+}
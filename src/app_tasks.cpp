@@ -0,0 +1,54 @@
+/**
+ * FreeRTOS Task Layout - see app_tasks.h
+ */
+
+#include "app_tasks.h"
+#include "config.h"
+#include "static_arena.h"
+
+QueueHandle_t controlQueue = nullptr;
+QueueHandle_t displayQueue = nullptr;
+TaskHandle_t audioTaskHandle = nullptr;
+
+const TickType_t telemetryPeriodTicks = MILLIS_TO_TICKS(TELEMETRY_INTERVAL_MS);
+
+bool appTasksStart() {
+    controlQueue = arenaCreateQueue(BUTTON_QUEUE_SIZE, sizeof(ControlEvent));
+    displayQueue = arenaCreateQueue(DISPLAY_QUEUE_SIZE, sizeof(DisplayEvent));
+    if (!controlQueue || !displayQueue) {
+        DEBUG_ERROR("task queue allocation failed");
+        return false;
+    }
+
+    audioTaskHandle = arenaCreateTask(audioTask, "audio", STACK_SIZE_AUDIO, nullptr,
+                                      TASK_PRIORITY_HIGH);
+    bool ok = audioTaskHandle != nullptr;
+    ok &= arenaCreateTask(controlTask, "control", STACK_SIZE_CONTROL, nullptr,
+                          TASK_PRIORITY_NORMAL) != nullptr;
+    if constexpr (FEATURE_OLED_DISPLAY) {
+        ok &= arenaCreateTask(displayTask, "display", STACK_SIZE_DISPLAY, nullptr,
+                              TASK_PRIORITY_LOW) != nullptr;
+    }
+    ok &= arenaCreateTask(telemetryTask, "telemetry", TASK_STACK_SIZE, nullptr,
+                          TASK_PRIORITY_LOW) != nullptr;
+
+    if (!ok) {
+        DEBUG_ERROR("task creation failed");
+    }
+    return ok;
+}
+
+bool postControlEvent(uint8_t type, uint8_t id, uint16_t value) {
+    if (!controlQueue) {
+        return false;
+    }
+    ControlEvent event = { type, id, value };
+    return xQueueSend(controlQueue, &event, 0) == pdTRUE;
+}
+
+bool postDisplayEvent(DisplayEvent event) {
+    if (!FEATURE_OLED_DISPLAY || !displayQueue) {
+        return false;
+    }
+    return xQueueSend(displayQueue, &event, 0) == pdTRUE;
+}
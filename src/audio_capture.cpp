@@ -0,0 +1,113 @@
+/**
+ * I2S Microphone Capture - see audio_capture.h
+ */
+
+#include "audio_capture.h"
+#include "config.h"
+
+#include <driver/i2s.h>
+
+#define CAPTURE_I2S_PORT        I2S_NUM_0
+#define CAPTURE_DMA_BUFFERS     2       // Double-buffered: one filling, one ready
+#define CAPTURE_EVENT_QUEUE     AUDIO_QUEUE_SIZE
+
+static QueueHandle_t i2sEventQueue = nullptr;
+static bool captureRunning = false;
+static uint32_t overrunCount = 0;
+
+#define CAPTURE_FRAME_BYTES     (AUDIO_FRAME_SIZE * sizeof(int16_t))
+
+bool audioCaptureBegin() {
+    // Assigned field by field: several members are unions in IDF 4.4
+    i2s_config_t i2sConfig = {};
+    i2sConfig.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX);
+    i2sConfig.sample_rate = AUDIO_SAMPLE_RATE;
+    i2sConfig.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+    i2sConfig.channel_format = I2S_CHANNEL_FMT_ONLY_LEFT;
+    i2sConfig.communication_format = I2S_COMM_FORMAT_STAND_I2S;
+    i2sConfig.intr_alloc_flags = ESP_INTR_FLAG_LEVEL1;
+    i2sConfig.dma_buf_count = CAPTURE_DMA_BUFFERS;
+    i2sConfig.dma_buf_len = AUDIO_FRAME_SIZE;
+
+    i2s_pin_config_t pinConfig = {};
+    pinConfig.mck_io_num = I2S_PIN_NO_CHANGE;
+    pinConfig.bck_io_num = PIN_I2S_SCK;
+    pinConfig.ws_io_num = PIN_I2S_WS;
+    pinConfig.data_out_num = I2S_PIN_NO_CHANGE;
+    pinConfig.data_in_num = PIN_I2S_SD;
+
+    if (i2s_driver_install(CAPTURE_I2S_PORT, &i2sConfig,
+                           CAPTURE_EVENT_QUEUE, &i2sEventQueue) != ESP_OK) {
+        DEBUG_ERROR("I2S driver install failed");
+        return false;
+    }
+    if (i2s_set_pin(CAPTURE_I2S_PORT, &pinConfig) != ESP_OK) {
+        DEBUG_ERROR("I2S pin config failed");
+        i2s_driver_uninstall(CAPTURE_I2S_PORT);
+        return false;
+    }
+
+    // The driver starts clocking immediately; hold it until the mic is on
+    i2s_stop(CAPTURE_I2S_PORT);
+    captureRunning = false;
+    return true;
+}
+
+void audioCaptureSetEnabled(bool enabled) {
+    if (!i2sEventQueue || enabled == captureRunning) {
+        return;
+    }
+
+    if (enabled) {
+        i2s_zero_dma_buffer(CAPTURE_I2S_PORT);
+        xQueueReset(i2sEventQueue);
+        i2s_start(CAPTURE_I2S_PORT);
+    } else {
+        i2s_stop(CAPTURE_I2S_PORT);
+    }
+    captureRunning = enabled;
+}
+
+bool audioCaptureEnabled() {
+    return captureRunning;
+}
+
+bool audioCaptureRead(int16_t* frame, TickType_t timeout) {
+    if (!i2sEventQueue) {
+        return false;
+    }
+
+    // While stopped no events arrive, so a blocking caller simply sleeps
+    // until capture is enabled and the first frame completes
+    i2s_event_t event;
+    while (xQueueReceive(i2sEventQueue, &event, timeout) == pdTRUE) {
+        if (event.type == I2S_EVENT_DMA_ERROR) {
+            overrunCount++;
+            continue;
+        }
+        if (event.type != I2S_EVENT_RX_DONE) {
+            continue;
+        }
+
+        // A full descriptor is ready, so this read never blocks. It is the
+        // only copy: DMA descriptor straight into the caller's frame.
+        size_t bytesRead = 0;
+        i2s_read(CAPTURE_I2S_PORT, frame, CAPTURE_FRAME_BYTES, &bytesRead, 0);
+        if (bytesRead != CAPTURE_FRAME_BYTES) {
+            if (captureRunning) {
+                overrunCount++;
+            }
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+size_t audioCaptureFrameSize() {
+    return AUDIO_FRAME_SIZE;
+}
+
+uint32_t audioCaptureOverruns() {
+    return overrunCount;
+}
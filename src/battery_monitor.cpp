@@ -0,0 +1,110 @@
+/**
+ * Battery Measurement - see battery_monitor.h
+ */
+
+#include "battery_monitor.h"
+#include "config.h"
+#include <driver/adc.h>
+#include <esp_adc_cal.h>
+
+// Battery voltage per ADC millivolt, in thousandths
+#define BAT_DIVIDER_X1000       ((uint32_t)(BAT_VOLTAGE_DIVIDER * 1000))
+
+// State of charge vs resting cell voltage, 10 % steps (typical Li-ion)
+static const uint16_t socCurveMv[] = {
+    (uint16_t)(BAT_EMPTY_VOLTAGE * 1000),   //   0 %
+    3620, 3710, 3750, 3790, 3820,           //  10 - 50 %
+    3870, 3940, 4020, 4110,                 //  60 - 90 %
+    (uint16_t)(BAT_FULL_VOLTAGE * 1000)     // 100 %
+};
+
+static adc1_channel_t channel;
+static esp_adc_cal_characteristics_t adcChars;
+static bool eFuseCalibration = false;
+
+static uint32_t lastSample = 0;
+static uint32_t filteredMvScaled = 0;   // IIR state, millivolts << BAT_FILTER_SHIFT
+static bool haveReading = false;
+static uint16_t millivolts = 0;
+static uint8_t percent = 0;
+
+static uint8_t socFromMillivolts(uint16_t mv) {
+    if (mv <= socCurveMv[0]) {
+        return 0;
+    }
+    for (uint8_t i = 1; i < ARRAY_SIZE(socCurveMv); i++) {
+        if (mv < socCurveMv[i]) {
+            uint16_t lo = socCurveMv[i - 1];
+            uint16_t span = socCurveMv[i] - lo;
+            return (uint8_t)((i - 1) * 10 + ((mv - lo) * 10 + span / 2) / span);
+        }
+    }
+    return 100;
+}
+
+static void sample() {
+    // Burst of one-shot conversions, averaged before the calibration curve
+    uint32_t sum = 0;
+    for (uint16_t i = 0; i < BAT_SAMPLES; i++) {
+        sum += adc1_get_raw(channel);
+    }
+    uint32_t adcMv = esp_adc_cal_raw_to_voltage(sum / BAT_SAMPLES, &adcChars);
+    uint32_t batteryMv = adcMv * BAT_DIVIDER_X1000 / 1000;
+
+    if (batteryMv > (uint32_t)(MAX_BATTERY_VOLTAGE * 1000) ||
+        batteryMv < (uint32_t)(MIN_BATTERY_VOLTAGE * 1000)) {
+        DEBUG_WARN("battery reading %u mV out of range, ignored", batteryMv);
+        return;
+    }
+
+    if (!haveReading) {
+        // Seed the filter so the first percentage is not a slow ramp from 0
+        filteredMvScaled = batteryMv << BAT_FILTER_SHIFT;
+        haveReading = true;
+    } else {
+        filteredMvScaled += batteryMv - (filteredMvScaled >> BAT_FILTER_SHIFT);
+    }
+
+    millivolts = (uint16_t)(filteredMvScaled >> BAT_FILTER_SHIFT);
+    percent = socFromMillivolts(millivolts);
+}
+
+bool batteryMonitorBegin(uint8_t adcPin) {
+    int ch = digitalPinToAnalogChannel(adcPin);
+    if (ch < 0) {
+        DEBUG_ERROR("GPIO%u has no ADC channel", adcPin);
+        return false;
+    }
+    channel = (adc1_channel_t)ch;
+
+    adc1_config_width(ADC_WIDTH_BIT_12);
+    adc1_config_channel_atten(channel, ADC_ATTENUATION);
+    eFuseCalibration = esp_adc_cal_check_efuse(ESP_ADC_CAL_VAL_EFUSE_TP) == ESP_OK;
+    esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTENUATION, ADC_WIDTH_BIT_12,
+                             ADC_VREF, &adcChars);
+
+    lastSample = millis();
+    sample();
+    return true;
+}
+
+bool batteryMonitorUpdate() {
+    if (millis() - lastSample < BAT_CHECK_INTERVAL_MS) {
+        return false;
+    }
+    lastSample = millis();
+    sample();
+    return true;
+}
+
+uint16_t batteryMonitorMillivolts() {
+    return millivolts;
+}
+
+uint8_t batteryMonitorPercent() {
+    return percent;
+}
+
+bool batteryMonitorCalibrated() {
+    return eFuseCalibration;
+}
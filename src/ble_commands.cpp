@@ -0,0 +1,129 @@
+/**
+ * Binary BLE Command Protocol - see ble_commands.h
+ */
+
+#include "ble_commands.h"
+#include "app_tasks.h"
+#include "ble_link.h"
+#include "config.h"
+
+typedef bool (*CommandHandler)(const uint8_t* value, uint8_t length);
+
+struct CommandEntry {
+    uint8_t opcode;
+    uint8_t length;             // Exact value length required
+    CommandHandler handler;
+};
+
+static uint32_t commandErrors = 0;
+
+static bool handleVolume(const uint8_t* value, uint8_t length) {
+    if (value[0] > QCC_VOLUME_MAX) {
+        return false;
+    }
+    return postControlEvent(CONTROL_SET_VOLUME, 0, value[0]);
+}
+
+static bool handleMute(const uint8_t* value, uint8_t length) {
+    if (value[0] > BLE_MUTE_TOGGLE) {
+        return false;
+    }
+    return postControlEvent(CONTROL_SET_MUTE, value[0]);
+}
+
+static bool handlePower(const uint8_t* value, uint8_t length) {
+    if (value[0] > 1) {
+        return false;
+    }
+    return postControlEvent(CONTROL_SET_POWER, value[0]);
+}
+
+static bool handleVadThreshold(const uint8_t* value, uint8_t length) {
+    uint16_t thresholdQ15 = value[0] | (value[1] << 8);
+    if (thresholdQ15 > 32767) {
+        return false;
+    }
+    return postControlEvent(CONTROL_SET_VAD_THRESHOLD, 0, thresholdQ15);
+}
+
+static bool handleNrLevel(const uint8_t* value, uint8_t length) {
+    if (value[0] > 100) {
+        return false;
+    }
+    return postControlEvent(CONTROL_SET_NR_LEVEL, 0, value[0]);
+}
+
+static bool handleDisplay(const uint8_t* value, uint8_t length) {
+    if (value[0] > 1) {
+        return false;
+    }
+    return postDisplayEvent(value[0] ? DISPLAY_WAKE : DISPLAY_SLEEP);
+}
+
+static const CommandEntry commandTable[] = {
+    { BLE_OP_VOLUME_SET,    1, handleVolume },
+    { BLE_OP_MUTE,          1, handleMute },
+    { BLE_OP_POWER,         1, handlePower },
+    { BLE_OP_VAD_THRESHOLD, 2, handleVadThreshold },
+    { BLE_OP_NR_LEVEL,      1, handleNrLevel },
+    { BLE_OP_DISPLAY,       1, handleDisplay },
+};
+
+static const CommandEntry* findCommand(uint8_t opcode) {
+    for (size_t i = 0; i < ARRAY_SIZE(commandTable); i++) {
+        if (commandTable[i].opcode == opcode) {
+            return &commandTable[i];
+        }
+    }
+    return nullptr;
+}
+
+class CommandCallbacks : public BLECharacteristicCallbacks {
+    void onWrite(BLECharacteristic* characteristic) {
+        // Runs on the BLE stack task: parse and queue only
+        bleLinkActivity();
+        bleCommandsDispatch(characteristic->getData(), characteristic->getLength());
+    }
+};
+
+static CommandCallbacks commandCallbacks;
+
+void bleCommandsBegin(BLECharacteristic* characteristic) {
+    characteristic->setCallbacks(&commandCallbacks);
+}
+
+size_t bleCommandsDispatch(const uint8_t* data, size_t length) {
+    size_t applied = 0;
+    size_t offset = 0;
+
+    while (offset + 2 <= length) {
+        uint8_t opcode = data[offset];
+        uint8_t valueLength = data[offset + 1];
+        const uint8_t* value = data + offset + 2;
+
+        if (offset + 2 + valueLength > length) {
+            DEBUG_WARN("truncated BLE command 0x%02x", opcode);
+            commandErrors++;
+            break;
+        }
+
+        const CommandEntry* entry = findCommand(opcode);
+        if (!entry || entry->length != valueLength || !entry->handler(value, valueLength)) {
+            DEBUG_WARN("rejected BLE command 0x%02x len %u", opcode, valueLength);
+            commandErrors++;
+            break;
+        }
+
+        applied++;
+        offset += 2 + valueLength;
+    }
+
+    if (offset < length && offset + 2 > length) {
+        commandErrors++;    // Trailing partial header
+    }
+    return applied;
+}
+
+uint32_t bleCommandErrors() {
+    return commandErrors;
+}
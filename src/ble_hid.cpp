@@ -0,0 +1,105 @@
+/**
+ * BLE HID-over-GATT Keyboard, Media Keys and Battery Service - see ble_hid.h
+ */
+
+#include "ble_hid.h"
+#include "config.h"
+#include <BLEDevice.h>
+#include <BLEHIDDevice.h>
+#include <BLESecurity.h>
+#include <BLE2902.h>
+
+#define BLE_APPEARANCE_KEYBOARD     0x03C1
+#define BLE_HID_COUNTRY_NONE        0x00
+#define BLE_HID_FLAG_REMOTE_WAKE    0x01
+#define BLE_PNP_SOURCE_USB          0x02
+#define BLE_UUID_BATTERY_LEVEL      0x2A19
+#define BLE_UUID_CCCD               0x2902
+
+struct InputReport {
+    uint8_t id;
+    BLECharacteristic* characteristic;
+    BLE2902* cccd;
+};
+
+static BLEServer* hidServer = nullptr;
+static InputReport inputs[] = {
+    { HID_REPORT_ID_KEYS, nullptr, nullptr },
+    { HID_REPORT_ID_MEDIA, nullptr, nullptr },
+};
+static BLECharacteristic* batteryLevel = nullptr;
+static uint8_t batterySent = 0xFF;      // Nothing notified yet
+
+static const InputReport* findInput(uint8_t reportId) {
+    for (const InputReport& input : inputs) {
+        if (input.id == reportId) {
+            return &input;
+        }
+    }
+    return nullptr;
+}
+
+static bool subscribed(const InputReport* input) {
+    return hidServer && hidServer->getConnectedCount() > 0 &&
+           input && input->cccd && input->cccd->getNotifications();
+}
+
+bool bleHidBegin(BLEServer* server) {
+    if (!server) {
+        return false;
+    }
+
+    static BLESecurity security;
+    security.setAuthenticationMode(ESP_LE_AUTH_REQ_SC_BOND);
+    security.setCapability(ESP_IO_CAP_NONE);
+    security.setInitEncryptionKeys(ESP_BLE_ENC_KEY_MASK | ESP_BLE_ID_KEY_MASK);
+
+    // Also creates the device information and battery services
+    static BLEHIDDevice hid(server);
+    hid.manufacturer()->setValue(USB_MANUFACTURER_STRING);
+    hid.pnp(BLE_PNP_SOURCE_USB, USB_VENDOR_ID, USB_PRODUCT_ID, 0x0100);
+    hid.hidInfo(BLE_HID_COUNTRY_NONE, BLE_HID_FLAG_REMOTE_WAKE);
+    hid.reportMap(const_cast<uint8_t*>(hidReportMap), hidReportMapSize);
+    for (InputReport& input : inputs) {
+        input.characteristic = hid.inputReport(input.id);
+        input.cccd = (BLE2902*)input.characteristic->getDescriptorByUUID(
+            BLEUUID((uint16_t)BLE_UUID_CCCD));
+    }
+    batteryLevel = hid.batteryService()->getCharacteristic(
+        BLEUUID((uint16_t)BLE_UUID_BATTERY_LEVEL));
+    hid.startServices();
+
+    BLEAdvertising* advertising = BLEDevice::getAdvertising();
+    advertising->setAppearance(BLE_APPEARANCE_KEYBOARD);
+    advertising->addServiceUUID(hid.hidService()->getUUID());
+
+    hidServer = server;
+    return batteryLevel != nullptr;
+}
+
+bool bleHidReady() {
+    return subscribed(findInput(HID_REPORT_ID_KEYS));
+}
+
+bool bleHidSendReport(uint8_t reportId, const void* data, uint8_t length) {
+    const InputReport* input = findInput(reportId);
+    if (!subscribed(input)) {
+        return false;
+    }
+    input->characteristic->setValue((uint8_t*)data, length);
+    input->characteristic->notify();
+    return true;
+}
+
+void bleHidSetBattery(uint8_t percent, bool connected) {
+    if (!batteryLevel || percent == batterySent) {
+        return;
+    }
+    // The value stays current for reads; a host that was away picks it up
+    // on reconnect and a notify only costs radio time on a real change
+    batteryLevel->setValue(&percent, 1);
+    if (connected) {
+        batteryLevel->notify();
+    }
+    batterySent = percent;
+}
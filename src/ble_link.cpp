@@ -0,0 +1,263 @@
+/**
+ * BLE Connection Manager - see ble_link.h
+ */
+
+#include "ble_link.h"
+#include "config.h"
+#include <BLEDevice.h>
+#include <esp_gap_ble_api.h>
+
+#define BLE_DEFAULT_MTU     23
+
+// Connection intervals are in 1.25 ms, supervision timeouts in 10 ms and
+// advertising intervals in 0.625 ms units
+static constexpr uint16_t connUnits(uint32_t ms) { return (uint16_t)(ms * 4 / 5); }
+static constexpr uint16_t timeoutUnits(uint32_t ms) { return (uint16_t)(ms / 10); }
+static constexpr uint16_t advUnits(uint32_t ms) { return (uint16_t)(ms * 8 / 5); }
+
+static_assert(connUnits(BT_ACTIVE_INTERVAL_MIN_MS) >= 6, "BLE intervals start at 7.5 ms");
+static_assert(connUnits(BT_IDLE_INTERVAL_MAX_MS) <= 3200, "BLE intervals end at 4 s");
+static_assert(BT_IDLE_TIMEOUT_MS > 2 * (1 + BT_IDLE_LATENCY) * BT_IDLE_INTERVAL_MAX_MS,
+              "Idle supervision timeout too short for the slave latency");
+static_assert(BT_ACTIVE_TIMEOUT_MS > 2 * BT_ACTIVE_INTERVAL_MAX_MS,
+              "Active supervision timeout too short");
+
+static BLEServer* linkServer = nullptr;
+static portMUX_TYPE linkLock = portMUX_INITIALIZER_UNLOCKED;
+
+static BleLinkState state = BLE_LINK_PAIRING;
+static BleLinkProfile profile = BLE_LINK_PROFILE_ACTIVE;
+static esp_bd_addr_t peer;
+static uint16_t connId = 0;
+static uint8_t attempt = 0;             // Reconnection attempts made
+static uint32_t stateSince = 0;
+static volatile uint32_t lastActivityMs = 0;
+static volatile uint8_t activeHolders = 0;     // BleLinkHolder bits
+static volatile int8_t rssi = BLE_LINK_RSSI_NONE;
+static volatile bool secure = false;    // Encrypted with bonded keys
+
+static void startAdvertising(uint32_t intervalMs) {
+    BLEAdvertising* advertising = BLEDevice::getAdvertising();
+    advertising->stop();
+    advertising->setMinInterval(advUnits(intervalMs));
+    advertising->setMaxInterval(advUnits(intervalMs + intervalMs / 2));
+    advertising->start();
+}
+
+static void requestPhy(BleLinkProfile p) {
+#if CONFIG_BT_BLE_50_FEATURES_SUPPORTED
+    // 2M halves the air time of a packet; idle keeps 1M for its range.
+    // The controller stays on 1M if the peer has no 2M support.
+    esp_ble_gap_phy_mask_t mask = p == BLE_LINK_PROFILE_ACTIVE ?
+        (ESP_BLE_GAP_PHY_1M_PREF_MASK | ESP_BLE_GAP_PHY_2M_PREF_MASK) :
+        ESP_BLE_GAP_PHY_1M_PREF_MASK;
+    esp_ble_gap_set_preferred_phy(peer, 0, mask, mask, ESP_BLE_GAP_PHY_OPTIONS_NO_PREF);
+#else
+    (void)p;
+#endif
+}
+
+// GAP requests only; the peer decides and may keep its own values
+static void applyProfile(BleLinkProfile p) {
+    if (p == BLE_LINK_PROFILE_ACTIVE) {
+        linkServer->updateConnParams(peer, connUnits(BT_ACTIVE_INTERVAL_MIN_MS),
+                                     connUnits(BT_ACTIVE_INTERVAL_MAX_MS), 0,
+                                     timeoutUnits(BT_ACTIVE_TIMEOUT_MS));
+    } else {
+        linkServer->updateConnParams(peer, connUnits(BT_IDLE_INTERVAL_MIN_MS),
+                                     connUnits(BT_IDLE_INTERVAL_MAX_MS), BT_IDLE_LATENCY,
+                                     timeoutUnits(BT_IDLE_TIMEOUT_MS));
+    }
+    requestPhy(p);
+    DEBUG_DEBUG("BLE link profile %s", p == BLE_LINK_PROFILE_ACTIVE ? "active" : "idle");
+}
+
+// Switch the profile if the link is up and it differs; returns true if
+// the caller has to send the request
+static bool takeProfile(BleLinkProfile p) {
+    bool change = false;
+    portENTER_CRITICAL(&linkLock);
+    if (state == BLE_LINK_CONNECTED && profile != p) {
+        profile = p;
+        change = true;
+    }
+    portEXIT_CRITICAL(&linkLock);
+    return change;
+}
+
+// Only from `from`, so a timeout racing a connect cannot undo it
+static bool transition(BleLinkState from, BleLinkState next) {
+    bool ok = false;
+    portENTER_CRITICAL(&linkLock);
+    if (state == from) {
+        state = next;
+        stateSince = millis();
+        ok = true;
+    }
+    portEXIT_CRITICAL(&linkLock);
+    return ok;
+}
+
+// RECONNECTING to BACKOFF, counting the attempt in the same critical section
+static bool beginBackoff() {
+    bool ok = false;
+    portENTER_CRITICAL(&linkLock);
+    if (state == BLE_LINK_RECONNECTING) {
+        state = BLE_LINK_BACKOFF;
+        stateSince = millis();
+        attempt++;
+        ok = true;
+    }
+    portEXIT_CRITICAL(&linkLock);
+    return ok;
+}
+
+// BLE stack task
+static void gapEvent(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param) {
+    if (event == ESP_GAP_BLE_READ_RSSI_COMPLETE_EVT &&
+        param->read_rssi_cmpl.status == ESP_BT_STATUS_SUCCESS && state == BLE_LINK_CONNECTED) {
+        rssi = param->read_rssi_cmpl.rssi;
+    } else if (event == ESP_GAP_BLE_AUTH_CMPL_EVT) {
+        // Also sent when a bonded host re-encrypts with its stored keys
+        const auto& auth = param->ble_security.auth_cmpl;
+        secure = auth.success && (auth.auth_mode & ESP_LE_AUTH_BOND);
+        DEBUG_DEBUG("BLE link %s", secure ? "encrypted, bonded" : "not secured");
+    }
+}
+
+void bleLinkBegin(BLEServer* server) {
+    linkServer = server;
+    BLEDevice::setMTU(BT_LINK_MTU);
+    BLEDevice::setCustomGapHandler(gapEvent);
+
+    // Suggest the active range so discovery after connecting is quick
+    BLEAdvertising* advertising = BLEDevice::getAdvertising();
+    advertising->setMinPreferred(connUnits(BT_ACTIVE_INTERVAL_MIN_MS));
+    advertising->setMaxPreferred(connUnits(BT_ACTIVE_INTERVAL_MAX_MS));
+
+    stateSince = millis();
+    startAdvertising(BT_ADV_FAST_INTERVAL_MS);
+}
+
+void bleLinkConnected(esp_ble_gatts_cb_param_t* param) {
+    portENTER_CRITICAL(&linkLock);
+    memcpy(peer, param->connect.remote_bda, sizeof(peer));
+    connId = param->connect.conn_id;
+    state = BLE_LINK_CONNECTED;
+    stateSince = millis();
+    profile = BLE_LINK_PROFILE_ACTIVE;
+    attempt = 0;
+    portEXIT_CRITICAL(&linkLock);
+
+    lastActivityMs = millis();
+    applyProfile(BLE_LINK_PROFILE_ACTIVE);
+}
+
+void bleLinkDisconnected() {
+    rssi = BLE_LINK_RSSI_NONE;
+    secure = false;
+    if (transition(BLE_LINK_CONNECTED, BLE_LINK_RECONNECTING)) {
+        startAdvertising(BT_ADV_FAST_INTERVAL_MS);
+    }
+}
+
+void bleLinkActivity() {
+    lastActivityMs = millis();
+    if (takeProfile(BLE_LINK_PROFILE_ACTIVE)) {
+        applyProfile(BLE_LINK_PROFILE_ACTIVE);
+    }
+}
+
+void bleLinkHoldActive(BleLinkHolder holder, bool held) {
+    portENTER_CRITICAL(&linkLock);
+    activeHolders = held ? (activeHolders | holder) : (activeHolders & ~holder);
+    portEXIT_CRITICAL(&linkLock);
+    if (held) {
+        bleLinkActivity();
+    }
+}
+
+void bleLinkService() {
+    if (!linkServer) {
+        return;
+    }
+    uint32_t now = millis();
+
+    portENTER_CRITICAL(&linkLock);
+    BleLinkState current = state;
+    uint32_t elapsed = now - stateSince;
+    uint8_t attempts = attempt;
+    portEXIT_CRITICAL(&linkLock);
+
+    switch (current) {
+        case BLE_LINK_CONNECTED:
+            if (!activeHolders && now - lastActivityMs >= BT_ACTIVE_HOLD_MS &&
+                takeProfile(BLE_LINK_PROFILE_IDLE)) {
+                applyProfile(BLE_LINK_PROFILE_IDLE);
+            }
+            break;
+        case BLE_LINK_PAIRING:
+            if (elapsed >= BT_PAIRING_TIMEOUT_MS &&
+                transition(BLE_LINK_PAIRING, BLE_LINK_DISCOVERABLE)) {
+                startAdvertising(BT_ADV_SLOW_INTERVAL_MS);
+            }
+            break;
+        case BLE_LINK_RECONNECTING:
+            if (elapsed < BT_RECONNECT_WINDOW_MS) {
+                break;
+            }
+            if (attempts + 1 >= BT_RECONNECT_ATTEMPTS) {
+                if (transition(BLE_LINK_RECONNECTING, BLE_LINK_DISCOVERABLE)) {
+                    startAdvertising(BT_ADV_SLOW_INTERVAL_MS);
+                    DEBUG_INFO("BLE reconnect gave up, slow advertising");
+                }
+            } else if (beginBackoff()) {
+                BLEDevice::getAdvertising()->stop();
+            }
+            break;
+        case BLE_LINK_BACKOFF:
+            // Gaps of 1x, 2x, 4x ... BT_RECONNECT_DELAY_MS
+            if (elapsed >= ((uint32_t)BT_RECONNECT_DELAY_MS << (attempts - 1)) &&
+                transition(BLE_LINK_BACKOFF, BLE_LINK_RECONNECTING)) {
+                startAdvertising(BT_ADV_FAST_INTERVAL_MS);
+            }
+            break;
+        case BLE_LINK_DISCOVERABLE:
+            break;
+    }
+}
+
+BleLinkState bleLinkState() {
+    return state;
+}
+
+bool bleLinkSecure() {
+    return state == BLE_LINK_CONNECTED && secure;
+}
+
+BleLinkProfile bleLinkProfile() {
+    return profile;
+}
+
+uint16_t bleLinkMtu() {
+    if (!linkServer || state != BLE_LINK_CONNECTED) {
+        return BLE_DEFAULT_MTU;
+    }
+    uint16_t mtu = linkServer->getPeerMTU(connId);
+    return mtu ? mtu : BLE_DEFAULT_MTU;
+}
+
+void bleLinkRequestRssi() {
+    if (state != BLE_LINK_CONNECTED) {
+        return;
+    }
+    esp_bd_addr_t addr;
+    portENTER_CRITICAL(&linkLock);
+    memcpy(addr, peer, sizeof(addr));
+    portEXIT_CRITICAL(&linkLock);
+    esp_ble_gap_read_rssi(addr);
+}
+
+int8_t bleLinkRssi() {
+    return rssi;
+}
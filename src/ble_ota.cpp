@@ -0,0 +1,381 @@
+/**
+ * Firmware Update over BLE - see ble_ota.h
+ */
+
+#include "ble_ota.h"
+#include "config.h"
+#include "ble_link.h"
+#include "spsc_ring.h"
+#include "static_arena.h"
+#include <BLEServer.h>
+#include <BLE2902.h>
+#include <esp_ota_ops.h>
+#include <mbedtls/ecdsa.h>
+#include <mbedtls/sha256.h>
+
+#define OTA_SERVICE_UUID        "12345678-1234-1234-1234-123456789abd"
+#define OTA_CONTROL_UUID        "87654321-4321-4321-4321-cba987654325"
+#define OTA_DATA_UUID           "87654321-4321-4321-4321-cba987654326"
+#define OTA_DIGEST_SIZE         32
+#define OTA_SIGNATURE_SIZE      64      // P-256 r || s
+#define OTA_PUBLIC_KEY_SIZE     65      // Uncompressed: 0x04 || X || Y
+#define OTA_CHUNK_HEADER        4       // offset u32
+#define OTA_CHUNK_MAX           (BT_LINK_MTU - 3 - OTA_CHUNK_HEADER)
+#define OTA_ACK_CHUNKS          (OTA_WINDOW_CHUNKS / 2)
+#define OTA_REQUEST_QUEUE_DEPTH 2
+
+static_assert(OTA_WINDOW_CHUNKS >= 2 && OTA_WINDOW_CHUNKS <= OTA_RING_CHUNKS,
+              "The ring has to hold a whole window");
+
+struct OtaChunk {
+    uint32_t offset;
+    uint16_t length;
+    uint8_t data[OTA_CHUNK_MAX];
+};
+
+struct OtaRequest {
+    uint8_t cmd;
+    uint32_t size;
+    uint8_t digest[OTA_DIGEST_SIZE];
+    uint8_t signature[OTA_SIGNATURE_SIZE];
+};
+
+static const uint8_t signingKey[OTA_PUBLIC_KEY_SIZE] = OTA_SIGNING_PUBLIC_KEY;
+
+// BLE stack task produces, OTA task consumes. Two slots when the feature
+// is off, so release builds without OTA keep the RAM.
+static SpscRing<OtaChunk, FEATURE_BLE_OTA ? OTA_RING_CHUNKS : 2> chunks;
+static QueueHandle_t requestQueue = nullptr;
+static TaskHandle_t otaTaskHandle = nullptr;
+static BLECharacteristic* controlCharacteristic = nullptr;
+static OtaRestartCallback restartCallback = nullptr;
+
+// OTA task state
+static volatile bool sessionOpen = false;
+static const esp_partition_t* target = nullptr;
+static esp_ota_handle_t handle = 0;
+static uint8_t expectedDigest[OTA_DIGEST_SIZE];
+static mbedtls_sha256_context sha;
+static uint32_t lastDataMs = 0;
+static uint8_t sinceAck = 0;
+static bool resyncSent = false;
+
+static BleOtaStats stats;
+
+static void notifyStatus(uint8_t status, const uint8_t* extra = nullptr, size_t extraLength = 0) {
+    uint8_t value[1 + sizeof(uint32_t) + 3];
+    value[0] = status;
+    memcpy(&value[1], &stats.committed, sizeof(uint32_t));
+    if (extraLength) {
+        memcpy(&value[1 + sizeof(uint32_t)], extra, extraLength);
+    }
+    controlCharacteristic->setValue(value, 1 + sizeof(uint32_t) + extraLength);
+    controlCharacteristic->notify();
+}
+
+static void sendReady() {
+    uint16_t chunkMax = bleLinkMtu() - 3 - OTA_CHUNK_HEADER;
+    if (chunkMax > OTA_CHUNK_MAX) {
+        chunkMax = OTA_CHUNK_MAX;
+    }
+    uint8_t extra[3] = { OTA_WINDOW_CHUNKS, (uint8_t)chunkMax, (uint8_t)(chunkMax >> 8) };
+    notifyStatus(OTA_STATUS_READY, extra, sizeof(extra));
+}
+
+static void closeSession() {
+    sessionOpen = false;
+    mbedtls_sha256_free(&sha);
+    stats.imageSize = 0;
+    bleLinkHoldActive(BLE_LINK_HOLD_OTA, false);
+}
+
+static void fail(OtaError error) {
+    if (sessionOpen) {
+        esp_ota_abort(handle);
+        closeSession();
+    }
+    DEBUG_WARN("OTA failed: error %u at %u bytes", error, stats.committed);
+    uint8_t code = error;
+    notifyStatus(OTA_STATUS_ERROR, &code, 1);
+}
+
+static void finish() {
+    uint8_t digest[OTA_DIGEST_SIZE];
+    mbedtls_sha256_finish_ret(&sha, digest);
+    if (memcmp(digest, expectedDigest, sizeof(digest)) != 0) {
+        fail(OTA_ERR_DIGEST);
+        return;
+    }
+
+    // Validates the image header and the app's own checksum
+    esp_err_t err = esp_ota_end(handle);
+    closeSession();
+    if (err == ESP_OK) {
+        err = esp_ota_set_boot_partition(target);
+    }
+    if (err != ESP_OK) {
+        DEBUG_WARN("OTA image rejected: %s", esp_err_to_name(err));
+        uint8_t code = OTA_ERR_IMAGE;
+        notifyStatus(OTA_STATUS_ERROR, &code, 1);
+        return;
+    }
+
+    DEBUG_INFO("OTA verified, %u bytes; restarting into %s", stats.committed, target->label);
+    notifyStatus(OTA_STATUS_DONE);
+    vTaskDelay(MILLIS_TO_TICKS(OTA_RESTART_DELAY_MS));     // Let the notification out
+    if (restartCallback) {
+        restartCallback();
+    }
+    ESP.restart();
+}
+
+static void writeChunk(const OtaChunk& chunk) {
+    uint32_t end = chunk.offset + chunk.length;
+    if (end > stats.imageSize) {
+        fail(OTA_ERR_SIZE);
+        return;
+    }
+    if (chunk.offset > stats.committed) {
+        // Something before this chunk is missing; one request per gap
+        if (!resyncSent) {
+            resyncSent = true;
+            stats.resyncs++;
+            notifyStatus(OTA_STATUS_RESYNC);
+        }
+        return;
+    }
+    if (end <= stats.committed) {
+        return;     // Already written, e.g. resent after a resume
+    }
+
+    uint32_t skip = stats.committed - chunk.offset;
+    const uint8_t* bytes = chunk.data + skip;
+    size_t length = chunk.length - skip;
+    if (esp_ota_write(handle, bytes, length) != ESP_OK) {
+        fail(OTA_ERR_FLASH);
+        return;
+    }
+    mbedtls_sha256_update_ret(&sha, bytes, length);
+    stats.committed += length;
+    lastDataMs = millis();
+    resyncSent = false;
+
+    if (stats.committed == stats.imageSize) {
+        finish();
+    } else if (++sinceAck >= OTA_ACK_CHUNKS) {
+        sinceAck = 0;
+        notifyStatus(OTA_STATUS_ACK);
+    }
+}
+
+// Written in order of arrival; dropped while no session is open
+static void writeChunks() {
+    const OtaChunk* chunk;
+    while (chunks.peek(&chunk)) {
+        if (sessionOpen) {
+            writeChunk(*chunk);
+        }
+        chunks.commitRead(1);
+    }
+}
+
+// The digest only counts if the release key signed it; the host that
+// sends it could be anyone within range
+static bool signatureValid(const OtaRequest& request) {
+    mbedtls_ecp_group group;
+    mbedtls_ecp_point key;
+    mbedtls_mpi r, s;
+    mbedtls_ecp_group_init(&group);
+    mbedtls_ecp_point_init(&key);
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+    bool valid =
+        mbedtls_ecp_group_load(&group, MBEDTLS_ECP_DP_SECP256R1) == 0 &&
+        mbedtls_ecp_point_read_binary(&group, &key, signingKey, sizeof(signingKey)) == 0 &&
+        mbedtls_ecp_check_pubkey(&group, &key) == 0 &&
+        mbedtls_mpi_read_binary(&r, request.signature, OTA_SIGNATURE_SIZE / 2) == 0 &&
+        mbedtls_mpi_read_binary(&s, request.signature + OTA_SIGNATURE_SIZE / 2,
+                                OTA_SIGNATURE_SIZE / 2) == 0 &&
+        mbedtls_ecdsa_verify(&group, request.digest, OTA_DIGEST_SIZE, &key, &r, &s) == 0;
+    mbedtls_mpi_free(&s);
+    mbedtls_mpi_free(&r);
+    mbedtls_ecp_point_free(&key);
+    mbedtls_ecp_group_free(&group);
+    return valid;
+}
+
+static void begin(const OtaRequest& request) {
+    if (sessionOpen && request.size == stats.imageSize &&
+        memcmp(request.digest, expectedDigest, OTA_DIGEST_SIZE) == 0) {
+        writeChunks();      // Whatever arrived before the link dropped
+        if (sessionOpen) {
+            DEBUG_INFO("OTA resumed at %u of %u bytes", stats.committed, stats.imageSize);
+            bleLinkHoldActive(BLE_LINK_HOLD_OTA, true);
+            sendReady();
+        }
+        return;
+    }
+    if (sessionOpen) {
+        esp_ota_abort(handle);
+        closeSession();
+    }
+    writeChunks();          // Drops stale chunks of the old session
+
+    stats.committed = 0;
+    if (!signatureValid(request)) {
+        fail(OTA_ERR_SIGNATURE);
+        return;
+    }
+    target = esp_ota_get_next_update_partition(nullptr);
+    if (!target) {
+        fail(OTA_ERR_NO_PARTITION);
+        return;
+    }
+    if (request.size == 0 || request.size > target->size) {
+        fail(OTA_ERR_SIZE);
+        return;
+    }
+    // Sectors are erased as the writes reach them, not all up front, so
+    // the BLE link never waits for a whole-partition erase
+    if (esp_ota_begin(target, OTA_WITH_SEQUENTIAL_WRITES, &handle) != ESP_OK) {
+        fail(OTA_ERR_FLASH);
+        return;
+    }
+
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts_ret(&sha, 0);
+    memcpy(expectedDigest, request.digest, OTA_DIGEST_SIZE);
+    stats.imageSize = request.size;
+    stats.resyncs = 0;
+    stats.chunksDropped = 0;
+    lastDataMs = millis();
+    sinceAck = 0;
+    resyncSent = false;
+    sessionOpen = true;
+
+    DEBUG_INFO("OTA started: %u bytes into %s", request.size, target->label);
+    bleLinkHoldActive(BLE_LINK_HOLD_OTA, true);
+    sendReady();
+}
+
+static void otaTask(void* param) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, sessionOpen ? MILLIS_TO_TICKS(OTA_SESSION_TIMEOUT_MS) :
+                                               portMAX_DELAY);
+
+        OtaRequest request;
+        while (xQueueReceive(requestQueue, &request, 0) == pdTRUE) {
+            if (request.cmd == OTA_CMD_BEGIN) {
+                begin(request);
+            } else if (sessionOpen) {
+                fail(OTA_ERR_ABORTED);
+            }
+        }
+        writeChunks();
+
+        if (sessionOpen && millis() - lastDataMs >= OTA_SESSION_TIMEOUT_MS) {
+            fail(OTA_ERR_TIMEOUT);
+        }
+    }
+}
+
+// BLE stack task: parse and hand over only
+class ControlCallbacks : public BLECharacteristicCallbacks {
+    void onWrite(BLECharacteristic* characteristic) {
+        if (!bleLinkSecure()) {
+            DEBUG_WARN("OTA command on a link that is not bonded and encrypted");
+            return;
+        }
+        bleLinkActivity();
+        const uint8_t* value = characteristic->getData();
+        size_t length = characteristic->getLength();
+
+        OtaRequest request = {};
+        if (length == 1 + sizeof(uint32_t) + OTA_DIGEST_SIZE + OTA_SIGNATURE_SIZE &&
+            value[0] == OTA_CMD_BEGIN) {
+            request.cmd = OTA_CMD_BEGIN;
+            memcpy(&request.size, &value[1], sizeof(uint32_t));
+            memcpy(request.digest, &value[1 + sizeof(uint32_t)], OTA_DIGEST_SIZE);
+            memcpy(request.signature, &value[1 + sizeof(uint32_t) + OTA_DIGEST_SIZE],
+                   OTA_SIGNATURE_SIZE);
+        } else if (length == 1 && value[0] == OTA_CMD_ABORT) {
+            request.cmd = OTA_CMD_ABORT;
+        } else {
+            DEBUG_WARN("rejected OTA command, %u bytes", (unsigned)length);
+            return;
+        }
+        if (xQueueSend(requestQueue, &request, 0) == pdTRUE) {
+            xTaskNotifyGive(otaTaskHandle);
+        }
+    }
+};
+
+// BLE stack task: one chunk straight into the ring
+class DataCallbacks : public BLECharacteristicCallbacks {
+    void onWrite(BLECharacteristic* characteristic) {
+        const uint8_t* value = characteristic->getData();
+        size_t length = characteristic->getLength();
+        if (length <= OTA_CHUNK_HEADER || length > OTA_CHUNK_HEADER + OTA_CHUNK_MAX ||
+            !bleLinkSecure()) {
+            return;
+        }
+        OtaChunk* slot;
+        if (!chunks.writeSpan(&slot)) {
+            stats.chunksDropped++;      // Shows up as a gap and a resync
+            return;
+        }
+        memcpy(&slot->offset, value, OTA_CHUNK_HEADER);
+        slot->length = (uint16_t)(length - OTA_CHUNK_HEADER);
+        memcpy(slot->data, value + OTA_CHUNK_HEADER, slot->length);
+        chunks.commitWrite(1);
+        xTaskNotifyGive(otaTaskHandle);
+    }
+};
+
+bool bleOtaBegin(BLEServer* server, OtaRestartCallback beforeRestart) {
+    if constexpr (!FEATURE_BLE_OTA) {
+        return true;
+    }
+    restartCallback = beforeRestart;
+    if (signingKey[0] != 0x04) {
+        DEBUG_WARN("OTA_SIGNING_PUBLIC_KEY not set, BLE updates will be refused");
+    }
+
+    requestQueue = arenaCreateQueue(OTA_REQUEST_QUEUE_DEPTH, sizeof(OtaRequest));
+    otaTaskHandle = arenaCreateTask(otaTask, "ota", OTA_TASK_STACK_SIZE, nullptr,
+                                    TASK_PRIORITY_LOW);
+    if (!requestQueue || !otaTaskHandle) {
+        DEBUG_ERROR("OTA task creation failed");
+        return false;
+    }
+
+    BLEService* service = server->createService(OTA_SERVICE_UUID);
+    controlCharacteristic = service->createCharacteristic(
+        OTA_CONTROL_UUID, BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_NOTIFY);
+    // The stack refuses writes until the link is encrypted, which makes
+    // the host pair first. Pairing is "just works" (ble_hid.cpp), so MITM
+    // protection is not available; bonding is checked on every write.
+    controlCharacteristic->setAccessPermissions(ESP_GATT_PERM_WRITE_ENCRYPTED);
+    static BLE2902 cccd;
+    cccd.setAccessPermissions(ESP_GATT_PERM_READ_ENCRYPTED | ESP_GATT_PERM_WRITE_ENCRYPTED);
+    controlCharacteristic->addDescriptor(&cccd);
+    static ControlCallbacks controlCallbacks;
+    controlCharacteristic->setCallbacks(&controlCallbacks);
+
+    BLECharacteristic* data =
+        service->createCharacteristic(OTA_DATA_UUID, BLECharacteristic::PROPERTY_WRITE_NR);
+    data->setAccessPermissions(ESP_GATT_PERM_WRITE_ENCRYPTED);
+    static DataCallbacks dataCallbacks;
+    data->setCallbacks(&dataCallbacks);
+
+    service->start();
+    return true;
+}
+
+bool bleOtaActive() {
+    return sessionOpen;
+}
+
+BleOtaStats bleOtaStats() {
+    return stats;
+}
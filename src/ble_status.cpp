@@ -0,0 +1,132 @@
+/**
+ * Event-Driven BLE Status Notifications - see ble_status.h
+ */
+
+#include "ble_status.h"
+#include "config.h"
+#include "profiler.h"
+
+static BLECharacteristic* statusCharacteristic = nullptr;
+static portMUX_TYPE statusLock = portMUX_INITIALIZER_UNLOCKED;
+
+static BleStatus current;           // Latest values from the application
+static BleStatus sent;              // Values in the last notification
+static bool sentValid = false;
+static bool pending = false;
+static uint8_t sequence = 0;
+static uint32_t lastNotifyMs = 0;
+static uint32_t notifyCount = 0;
+
+static bool sameStatus(const BleStatus& a, const BleStatus& b) {
+#if BT_STATUS_TEXT_COMPAT
+    if (a.batteryPercent != b.batteryPercent) {
+        return false;
+    }
+#endif
+    return a.volume == b.volume && a.flags == b.flags;
+}
+
+// Encode and send `status`. Runs outside statusLock.
+static void sendStatus(const BleStatus& status, uint8_t seq, bool connected) {
+    PROFILE_SCOPE(PROF_BLE_NOTIFY);
+#if BT_STATUS_TEXT_COMPAT
+    (void)seq;
+    char text[16];
+    int length = snprintf(text, sizeof(text), "%u,%u,%u",
+                          status.volume,
+                          (status.flags & BLE_STATUS_MUTED) ? 1 : 0,
+                          status.batteryPercent);
+    statusCharacteristic->setValue((uint8_t*)text, length);
+#else
+    BleStatusPacket packet;
+    packet.version = BLE_STATUS_VERSION;
+    packet.sequence = seq;
+    packet.volume = status.volume;
+    packet.flags = status.flags;
+    statusCharacteristic->setValue((uint8_t*)&packet, sizeof(packet));
+#endif
+
+    // The value is kept current for reads even with no client connected
+    if (connected) {
+        statusCharacteristic->notify();
+        notifyCount++;
+    }
+}
+
+// Decide under the lock whether to send now; copies the values to send and
+// claims their sequence number, as the control and telemetry tasks both send
+static bool takeDue(BleStatus* out, uint8_t* seq) {
+    uint32_t now = millis();
+    bool due = false;
+
+    portENTER_CRITICAL(&statusLock);
+    if (pending && (!sentValid || now - lastNotifyMs >= BT_STATUS_MIN_INTERVAL_MS)) {
+        *out = current;
+        *seq = sequence++;
+        sent = current;
+        sentValid = true;
+        pending = false;
+        lastNotifyMs = now;
+        due = true;
+    }
+    portEXIT_CRITICAL(&statusLock);
+    return due;
+}
+
+void bleStatusBegin(BLECharacteristic* characteristic) {
+    statusCharacteristic = characteristic;
+}
+
+void bleStatusUpdate(const BleStatus& status, bool connected) {
+    if (!statusCharacteristic) {
+        return;
+    }
+
+    portENTER_CRITICAL(&statusLock);
+    current = status;
+    if (!sentValid || !sameStatus(current, sent)) {
+        pending = true;
+    } else {
+        pending = false;    // Changed and changed back before it was sent
+    }
+    portEXIT_CRITICAL(&statusLock);
+
+    BleStatus out;
+    uint8_t seq;
+    if (takeDue(&out, &seq)) {
+        sendStatus(out, seq, connected);
+    }
+}
+
+void bleStatusService(bool connected) {
+    BleStatus out;
+    uint8_t seq;
+    if (statusCharacteristic && takeDue(&out, &seq)) {
+        sendStatus(out, seq, connected);
+    }
+}
+
+void bleStatusResend() {
+    portENTER_CRITICAL(&statusLock);
+    sentValid = false;
+    pending = true;
+    portEXIT_CRITICAL(&statusLock);
+}
+
+void bleStatusNotifyMute(bool muted, bool connected) {
+#if BT_STATUS_TEXT_COMPAT
+    if (statusCharacteristic && connected) {
+        statusCharacteristic->setValue(muted ? "MUTE_ON" : "MUTE_OFF");
+        statusCharacteristic->notify();
+        notifyCount++;
+    }
+#else
+    // The binary record already carries BLE_STATUS_MUTED
+    (void)muted;
+    (void)connected;
+#endif
+}
+
+uint32_t bleStatusNotifyCount() {
+    return notifyCount;
+}
@@ -0,0 +1,72 @@
+/**
+ * Boot Timing - see boot_profile.h
+ */
+
+#include "boot_profile.h"
+#include "config.h"
+#include <BLEServer.h>
+#include <esp_timer.h>
+
+#define BOOT_PROFILE_UUID       "87654321-4321-4321-4321-cba987654327"
+
+static const char* const stepNames[BOOT_STEP_COUNT] = {
+    "log", "settings", "ble", "advertising", "battery", "codec_link",
+    "mic", "tasks", "buttons_ready", "setup_done", "splash",
+};
+
+static volatile uint32_t stepMicros[BOOT_STEP_COUNT];
+static bool reported = false;
+
+void bootMark(BootStep step) {
+    if (step < BOOT_STEP_COUNT && !stepMicros[step]) {
+        uint32_t now = (uint32_t)esp_timer_get_time();
+        stepMicros[step] = now ? now : 1;
+    }
+}
+
+uint32_t bootStepMicros(BootStep step) {
+    return step < BOOT_STEP_COUNT ? stepMicros[step] : 0;
+}
+
+// Rebuild the record on every read, in the BLE stack's task
+class BootProfileCallbacks : public BLECharacteristicCallbacks {
+    void onRead(BLECharacteristic* characteristic) {
+        uint8_t record[2 + BOOT_STEP_COUNT * sizeof(uint32_t)];
+        record[0] = BOOT_PROFILE_VERSION;
+        record[1] = BOOT_STEP_COUNT;
+        for (uint8_t i = 0; i < BOOT_STEP_COUNT; i++) {
+            uint32_t micros = stepMicros[i];
+            memcpy(&record[2 + i * sizeof(uint32_t)], &micros, sizeof(micros));
+        }
+        characteristic->setValue(record, sizeof(record));
+    }
+};
+
+void bootProfileBleBegin(BLEService* service) {
+    BLECharacteristic* characteristic =
+        service->createCharacteristic(BOOT_PROFILE_UUID, BLECharacteristic::PROPERTY_READ);
+    static BootProfileCallbacks callbacks;
+    characteristic->setCallbacks(&callbacks);
+}
+
+void bootProfileReport() {
+    if (reported) {
+        return;
+    }
+    reported = true;
+    DEBUG_INFO("boot: advertising after %u ms, buttons after %u ms",
+               stepMicros[BOOT_ADVERTISING] / 1000, stepMicros[BOOT_BUTTONS_READY] / 1000);
+    uint32_t previous = 0;
+    for (uint8_t i = 0; i < BOOT_STEP_COUNT; i++) {
+        if (!stepMicros[i]) {
+            continue;
+        }
+        if (i == BOOT_SPLASH) {
+            DEBUG_INFO("boot %-13s %7u us (display task)", stepNames[i], stepMicros[i]);
+            continue;
+        }
+        DEBUG_INFO("boot %-13s %7u us (+%u)", stepNames[i], stepMicros[i],
+                   stepMicros[i] - previous);
+        previous = stepMicros[i];
+    }
+}
@@ -0,0 +1,245 @@
+/**
+ * Interrupt-Driven Button Engine - see buttons.h
+ */
+
+#include "buttons.h"
+#include "app_tasks.h"
+#include "config.h"
+#include "static_arena.h"
+#include <driver/gpio.h>
+#include <hal/gpio_ll.h>
+
+// Per-button gesture options
+#define BTN_FLAG_REPEAT         0x01    // Auto-repeat while held
+#define BTN_FLAG_DOUBLE         0x02    // Detect double-click (delays CLICK)
+#define BTN_FLAG_LEADING        0x04    // Accept the press on its first edge
+
+struct ButtonState {
+    bool stablePressed;         // Debounced level
+    bool settling;              // Edge seen, waiting for BUTTON_DEBOUNCE_MS
+    bool longFired;
+    bool comboHeld;             // Part of a combo; no gestures until release
+    uint8_t clicks;             // Clicks waiting for the double-click window
+    uint32_t settleAt;
+    uint32_t pressedAt;
+    uint32_t nextRepeatAt;
+    uint32_t clickDeadline;
+};
+
+// Indexed by ButtonId
+static DRAM_ATTR const uint8_t buttonPins[BUTTON_COUNT] = {
+    PIN_BTN_PWR, PIN_BTN_VOL_UP, PIN_BTN_VOL_DN, PIN_BTN_MUTE
+};
+static const uint8_t buttonFlags[BUTTON_COUNT] = {
+    BTN_FLAG_DOUBLE, BTN_FLAG_REPEAT, BTN_FLAG_REPEAT, BTN_FLAG_LEADING
+};
+static ButtonState buttons[BUTTON_COUNT];
+
+static TaskHandle_t buttonTaskHandle = nullptr;
+static ButtonPressHook pressHook = nullptr;
+
+static void IRAM_ATTR buttonIsr(void* arg) {
+    uint32_t id = (uint32_t)(uintptr_t)arg;
+#if POWER_WAKE_ON_BUTTON && POWER_LIGHT_SLEEP
+    // Light sleep can only be left on a GPIO level, so the interrupts are
+    // level-triggered and re-armed for the opposite level on every change
+    gpio_num_t pin = (gpio_num_t)buttonPins[id];
+    gpio_ll_set_intr_type(&GPIO, pin, gpio_ll_get_level(&GPIO, pin) ?
+                          GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+#endif
+    BaseType_t woken = pdFALSE;
+    xTaskNotifyFromISR(buttonTaskHandle, 1UL << id, eSetBits, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static inline bool isDue(uint32_t now, uint32_t deadline) {
+    return (int32_t)(now - deadline) >= 0;
+}
+
+static void emit(uint8_t id, ButtonAction action) {
+    postControlEvent(CONTROL_BUTTON, id, action);
+#if DEBUG_BUTTON_EVENTS
+    DEBUG_INFO("button %u action %u", id, action);
+#endif
+}
+
+static void onPress(uint8_t id, uint32_t now) {
+    ButtonState& b = buttons[id];
+    b.pressedAt = now;
+    b.longFired = false;
+    b.nextRepeatAt = now + BUTTON_REPEAT_DELAY_MS;
+
+    // A second button going down shortly after the first one is a combo
+    for (uint8_t other = 0; other < BUTTON_COUNT; other++) {
+        ButtonState& o = buttons[other];
+        if (other != id && o.stablePressed && !o.comboHeld &&
+            now - o.pressedAt <= BUTTON_COMBO_TIMEOUT_MS) {
+            b.comboHeld = true;
+            o.comboHeld = true;
+            b.clicks = 0;
+            o.clicks = 0;
+            emit(BUTTON_COMBO_ID(other, id), BUTTON_COMBO);
+            return;
+        }
+    }
+
+    if (pressHook) {
+        pressHook(id);
+    }
+    emit(id, BUTTON_PRESS);
+}
+
+static void onRelease(uint8_t id, uint32_t now) {
+    ButtonState& b = buttons[id];
+    if (b.comboHeld) {
+        b.comboHeld = false;
+        return;
+    }
+    if (b.longFired) {
+        return;     // Long press already reported; release is not a click
+    }
+
+    if (!(buttonFlags[id] & BTN_FLAG_DOUBLE)) {
+        emit(id, BUTTON_CLICK);
+    } else if (b.clicks > 0) {
+        b.clicks = 0;
+        emit(id, BUTTON_DOUBLE_CLICK);
+    } else {
+        b.clicks = 1;
+        b.clickDeadline = now + BUTTON_DOUBLE_CLICK_MS;
+    }
+}
+
+static void serviceButton(uint8_t id, uint32_t now) {
+    ButtonState& b = buttons[id];
+
+    if (b.settling && isDue(now, b.settleAt)) {
+        b.settling = false;
+        bool pressed = digitalRead(buttonPins[id]) == LOW;  // Active low
+        if (pressed != b.stablePressed) {
+            b.stablePressed = pressed;
+            if (pressed) {
+                onPress(id, now);
+            } else {
+                onRelease(id, now);
+            }
+        }
+    }
+
+    if (b.stablePressed && !b.comboHeld) {
+        if (!b.longFired && isDue(now, b.pressedAt + BUTTON_LONG_PRESS_MS)) {
+            b.longFired = true;
+            b.clicks = 0;
+            emit(id, BUTTON_LONG_PRESS);
+        }
+        if ((buttonFlags[id] & BTN_FLAG_REPEAT) && isDue(now, b.nextRepeatAt)) {
+            b.nextRepeatAt += BUTTON_REPEAT_MS;
+            emit(id, BUTTON_REPEAT);
+        }
+    }
+
+    if (b.clicks > 0 && !b.stablePressed && isDue(now, b.clickDeadline)) {
+        b.clicks = 0;
+        emit(id, BUTTON_CLICK);
+    }
+}
+
+// Ticks until the earliest pending deadline, or portMAX_DELAY when idle
+static TickType_t nextTimeout(uint32_t now) {
+    bool pending = false;
+    uint32_t earliest = 0;
+
+    auto consider = [&](uint32_t deadline) {
+        if (!pending || (int32_t)(deadline - earliest) < 0) {
+            earliest = deadline;
+            pending = true;
+        }
+    };
+
+    for (uint8_t id = 0; id < BUTTON_COUNT; id++) {
+        const ButtonState& b = buttons[id];
+        if (b.settling) {
+            consider(b.settleAt);
+        }
+        if (b.stablePressed && !b.comboHeld) {
+            if (!b.longFired) {
+                consider(b.pressedAt + BUTTON_LONG_PRESS_MS);
+            }
+            if (buttonFlags[id] & BTN_FLAG_REPEAT) {
+                consider(b.nextRepeatAt);
+            }
+        }
+        if (b.clicks > 0 && !b.stablePressed) {
+            consider(b.clickDeadline);
+        }
+    }
+
+    if (!pending) {
+        return portMAX_DELAY;
+    }
+    int32_t remaining = (int32_t)(earliest - now);
+    return remaining > 0 ? MILLIS_TO_TICKS(remaining) : 0;
+}
+
+static void buttonTask(void* param) {
+    uint32_t now = millis();
+    for (;;) {
+        uint32_t edges = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &edges, nextTimeout(now));
+        now = millis();
+
+        for (uint8_t id = 0; id < BUTTON_COUNT; id++) {
+            if (edges & (1UL << id)) {
+                ButtonState& b = buttons[id];
+                if ((buttonFlags[id] & BTN_FLAG_LEADING) && !b.settling &&
+                    !b.stablePressed && digitalRead(buttonPins[id]) == LOW) {
+                    // An idle button going low is a press; a glitch shorter
+                    // than the interrupt latency already reads high again
+                    b.stablePressed = true;
+                    onPress(id, now);
+                }
+                // Restart the settle window on every bounce
+                b.settling = true;
+                b.settleAt = now + BUTTON_DEBOUNCE_MS;
+            }
+            serviceButton(id, now);
+        }
+    }
+}
+
+bool buttonsBegin(ButtonPressHook hook) {
+    pressHook = hook;
+    buttonTaskHandle = arenaCreateTask(buttonTask, "buttons", STACK_SIZE_BUTTON, nullptr,
+                                       TASK_PRIORITY_NORMAL);
+    if (!buttonTaskHandle) {
+        DEBUG_ERROR("button task creation failed");
+        return false;
+    }
+
+    for (uint8_t id = 0; id < BUTTON_COUNT; id++) {
+        pinMode(buttonPins[id], INPUT_PULLUP);
+        // A button already held at boot is ignored until it is released
+        buttons[id].stablePressed = digitalRead(buttonPins[id]) == LOW;
+        buttons[id].comboHeld = buttons[id].stablePressed;
+        attachInterruptArg(digitalPinToInterrupt(buttonPins[id]), buttonIsr,
+                           (void*)(uintptr_t)id, CHANGE);
+#if POWER_WAKE_ON_BUTTON && POWER_LIGHT_SLEEP
+        // Arm for the level that ends the current state; also a wake source
+        gpio_wakeup_enable((gpio_num_t)buttonPins[id], buttons[id].stablePressed ?
+                           GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+#endif
+    }
+    return true;
+}
+
+bool buttonsBusy() {
+    for (uint8_t id = 0; id < BUTTON_COUNT; id++) {
+        const ButtonState& b = buttons[id];
+        if (b.stablePressed || b.settling || b.clicks > 0) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,89 @@
+/**
+ * TP4056 Charge State Estimator - see charger.h
+ */
+
+#include "charger.h"
+#include "config.h"
+#include "battery_monitor.h"
+#include "static_arena.h"
+
+static uint8_t pin = 0;
+static ChargeChangeCallback changeCallback = nullptr;
+static TimerHandle_t debounceTimer = nullptr;
+
+// Written by the timer task only
+static volatile ChargeState state = CHARGE_DISCHARGING;
+
+static void IRAM_ATTR statIsr() {
+    // Every bounce restarts the debounce window
+    BaseType_t woken = pdFALSE;
+    xTimerResetFromISR(debounceTimer, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static bool readStat() {
+    return digitalRead(pin) == LOW;
+}
+
+static uint16_t batteryMv() {
+    return FEATURE_BATTERY_MONITOR ? batteryMonitorMillivolts() : 0;
+}
+
+static ChargeState nextState(ChargeState current, bool charging, uint16_t mv) {
+    if (charging) {
+        return CHARGE_CHARGING;
+    }
+    switch (current) {
+        case CHARGE_CHARGED:
+            return mv < CHARGE_FULL_MV - CHARGE_HYST_MV ? CHARGE_DISCHARGING : CHARGE_CHARGED;
+        default:
+            // Terminated charge, or a full cell the TP4056 did not start on
+            return mv >= CHARGE_FULL_MV ? CHARGE_CHARGED : CHARGE_DISCHARGING;
+    }
+}
+
+// Timer task: STAT has held for the debounce time, or a battery reading
+// arrived
+static void evaluate(TimerHandle_t timer) {
+    bool charging = readStat();
+    uint16_t mv = batteryMv();
+    ChargeState next = nextState(state, charging, mv);
+    if (next == state) {
+        return;
+    }
+    state = next;
+    DEBUG_INFO("charge state %u (STAT %s, %u mV)", next, charging ? "low" : "high", mv);
+    if (changeCallback) {
+        changeCallback(next);
+    }
+}
+
+bool chargerBegin(uint8_t statPin, ChargeChangeCallback onChange) {
+    pin = statPin;
+    changeCallback = onChange;
+    debounceTimer = arenaCreateTimer("charger", MILLIS_TO_TICKS(CHARGER_STAT_DEBOUNCE_MS),
+                                     false, nullptr, evaluate);
+    if (!debounceTimer) {
+        DEBUG_ERROR("charger timer creation failed");
+        return false;
+    }
+    pinMode(pin, INPUT);
+    // Seeded from STAT and the first battery reading, so a full battery at
+    // boot reads as charged without waiting for a charge cycle
+    state = nextState(CHARGE_DISCHARGING, readStat(), batteryMv());
+    attachInterrupt(digitalPinToInterrupt(pin), statIsr, CHANGE);
+    return true;
+}
+
+void chargerService(bool batteryUpdated) {
+    // Also re-reads STAT, in case an edge was lost in light sleep
+    if (batteryUpdated) {
+        xTimerReset(debounceTimer, 0);
+    }
+}
+
+ChargeState chargerState() {
+    return state;
+}
@@ -0,0 +1,46 @@
+/**
+ * Serial Console Commands - see console.h
+ */
+
+#include "console.h"
+#include "config.h"
+#include "profiler.h"
+#include "telemetry_log.h"
+
+static char line[CONSOLE_LINE_MAX];
+static uint8_t length = 0;
+static bool overflow = false;       // Current line is too long; skip it
+
+static void runCommand(const char* command, Stream& console) {
+    if (strcmp(command, "telem") == 0) {
+        telemetryLogPrint(console);
+    } else if (strcmp(command, "telem clear") == 0) {
+        telemetryLogClear();
+        console.println("telemetry cleared");
+    } else if (!PROFILER_ENABLED) {
+        return;
+    } else if (strcmp(command, "prof") == 0) {
+        profilerPrint(console);
+    } else if (strcmp(command, "prof reset") == 0) {
+        profilerReset();
+        console.println("profiler reset");
+    }
+}
+
+void consoleService(Stream& console) {
+    while (console.available() > 0) {
+        char c = (char)console.read();
+        if (c == '\r' || c == '\n') {
+            if (length && !overflow) {
+                line[length] = '\0';
+                runCommand(line, console);
+            }
+            length = 0;
+            overflow = false;
+        } else if (length < CONSOLE_LINE_MAX - 1) {
+            line[length++] = c;
+        } else {
+            overflow = true;
+        }
+    }
+}
@@ -0,0 +1,153 @@
+/**
+ * Change-Driven OLED Status View - see display_view.h
+ */
+
+#include "display_view.h"
+#include "config.h"
+#include "profiler.h"
+
+#include <Wire.h>
+
+#define VIEW_ROW_TITLE          0       // Row top edges in pixels
+#define VIEW_ROW_BATTERY        10
+#define VIEW_ROW_STATUS         20
+#define VIEW_ROW_HEIGHT         8       // Text size 1
+#define VIEW_PAGE_COUNT         (SCREEN_HEIGHT / 8)
+#define VIEW_I2C_CHUNK          64      // Data bytes per I2C transaction
+
+static Adafruit_SSD1306* view = nullptr;
+static DisplayState drawn;
+static bool drawnValid = false;
+static bool panelOn = true;
+static uint32_t pagesSent = 0;
+
+// Pages covered by a text row starting at pixel row `y`
+static uint8_t rowPages(int16_t y) {
+    uint8_t first = y / 8;
+    uint8_t last = (y + VIEW_ROW_HEIGHT - 1) / 8;
+    return (uint8_t)(((1 << (last + 1)) - 1) & ~((1 << first) - 1));
+}
+
+static void beginRow(int16_t y) {
+    view->fillRect(0, y, SCREEN_WIDTH, VIEW_ROW_HEIGHT, BLACK);
+    view->setCursor(0, y);
+}
+
+// Send one contiguous run of pages from the framebuffer
+static void flushPages(uint8_t firstPage, uint8_t lastPage) {
+    view->ssd1306_command(SSD1306_COLUMNADDR);
+    view->ssd1306_command(0);
+    view->ssd1306_command(SCREEN_WIDTH - 1);
+    view->ssd1306_command(SSD1306_PAGEADDR);
+    view->ssd1306_command(firstPage);
+    view->ssd1306_command(lastPage);
+
+    const uint8_t* data = view->getBuffer() + firstPage * SCREEN_WIDTH;
+    size_t remaining = (size_t)(lastPage - firstPage + 1) * SCREEN_WIDTH;
+    while (remaining > 0) {
+        size_t chunk = remaining < VIEW_I2C_CHUNK ? remaining : VIEW_I2C_CHUNK;
+        Wire.beginTransmission(OLED_I2C_ADDR);
+        Wire.write((uint8_t)0x40);      // Co = 0, D/C = 1: data stream
+        Wire.write(data, chunk);
+        Wire.endTransmission();
+        data += chunk;
+        remaining -= chunk;
+    }
+    pagesSent += lastPage - firstPage + 1;
+}
+
+void displayViewBegin(Adafruit_SSD1306* display) {
+    view = display;
+    drawnValid = false;
+}
+
+void displayViewInvalidate() {
+    drawnValid = false;
+}
+
+void displayViewSetPower(bool on) {
+    if (!view || on == panelOn) {
+        return;
+    }
+    view->ssd1306_command(on ? SSD1306_DISPLAYON : SSD1306_DISPLAYOFF);
+    panelOn = on;
+    drawnValid = false;
+}
+
+bool displayViewPowered() {
+    return panelOn;
+}
+
+bool displayViewRender(const DisplayState& state) {
+    if (!view || !panelOn) {
+        return false;
+    }
+    PROFILE_SCOPE(PROF_DISPLAY);
+
+    uint8_t dirtyPages = 0;
+    view->setTextSize(1);
+    view->setTextColor(WHITE);
+
+    if (!drawnValid) {
+        view->clearDisplay();
+        view->setCursor(0, VIEW_ROW_TITLE);
+        view->print("ESP32-C3 Headset");
+        dirtyPages = (1 << VIEW_PAGE_COUNT) - 1;
+    }
+
+    if (!drawnValid ||
+        state.charging != drawn.charging ||
+        state.chargeComplete != drawn.chargeComplete ||
+        (!state.charging && !state.chargeComplete &&
+         state.batteryPercent != drawn.batteryPercent)) {
+        beginRow(VIEW_ROW_BATTERY);
+        if (state.charging) {
+            view->print("Battery: Charging");
+        } else if (state.chargeComplete) {
+            view->print("Battery: Full");
+        } else {
+            view->printf("Battery: %u%%", state.batteryPercent);
+        }
+        dirtyPages |= rowPages(VIEW_ROW_BATTERY);
+    }
+
+    if (!drawnValid ||
+        state.volume != drawn.volume ||
+        state.muted != drawn.muted ||
+        state.connected != drawn.connected ||
+        (!state.muted && state.voice != drawn.voice)) {
+        beginRow(VIEW_ROW_STATUS);
+        view->printf("Vol:%d %s %s",
+                     state.volume,
+                     state.muted ? "MUTE" : (state.voice ? "VOICE" : ""),
+                     state.connected ? "CONN" : "DISC");
+        dirtyPages |= rowPages(VIEW_ROW_STATUS);
+    }
+
+    drawn = state;
+    drawnValid = true;
+
+    if (dirtyPages == 0) {
+        return false;   // Nothing changed: no I2C traffic
+    }
+
+    // Coalesce adjacent dirty pages into single windowed writes
+    uint8_t page = 0;
+    while (page < VIEW_PAGE_COUNT) {
+        if (!(dirtyPages & (1 << page))) {
+            page++;
+            continue;
+        }
+        uint8_t last = page;
+        while (last + 1 < VIEW_PAGE_COUNT && (dirtyPages & (1 << (last + 1)))) {
+            last++;
+        }
+        flushPages(page, last);
+        page = last + 1;
+    }
+    return true;
+}
+
+uint32_t displayViewPagesSent() {
+    return pagesSent;
+}
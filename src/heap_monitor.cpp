@@ -0,0 +1,62 @@
+/**
+ * Heap Monitor - see heap_monitor.h
+ */
+
+#include "heap_monitor.h"
+#include "config.h"
+#include <esp_heap_caps.h>
+
+static HeapStats stats;
+static uint32_t baseline = 0;
+static uint32_t lastSample = 0;
+static bool low = false;
+
+static void sample() {
+    stats.freeBytes = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    stats.largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    stats.minFree = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    stats.sinceStartup = (int32_t)(stats.freeBytes - baseline);
+    stats.fragmentation = stats.freeBytes ?
+        (uint8_t)(100 - (uint64_t)stats.largestBlock * 100 / stats.freeBytes) : 100;
+}
+
+void heapMonitorBegin() {
+    baseline = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    lastSample = millis();
+    sample();
+    DEBUG_INFO("heap after startup: %u free, largest block %u",
+               stats.freeBytes, stats.largestBlock);
+}
+
+bool heapMonitorService() {
+    if (millis() - lastSample < HEAP_CHECK_INTERVAL_MS) {
+        return false;
+    }
+    lastSample = millis();
+    sample();
+
+    bool nowLow = stats.freeBytes < HEAP_SIZE_MIN ||
+                  stats.fragmentation > HEAP_FRAGMENTATION_MAX;
+    if (stats.sinceStartup < -(int32_t)HEAP_LEAK_WARN_BYTES) {
+        DEBUG_WARN("heap: %d bytes lost since startup", -stats.sinceStartup);
+    }
+    if (nowLow == low) {
+        return false;
+    }
+    low = nowLow;
+    if (low) {
+        DEBUG_WARN("heap low: %u free (min %u), largest block %u, %u%% fragmented",
+                   stats.freeBytes, stats.minFree, stats.largestBlock, stats.fragmentation);
+    } else {
+        DEBUG_INFO("heap recovered: %u free", stats.freeBytes);
+    }
+    return true;
+}
+
+HeapStats heapMonitorStats() {
+    return stats;
+}
+
+bool heapMonitorLow() {
+    return low;
+}
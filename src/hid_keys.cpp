@@ -0,0 +1,165 @@
+/**
+ * Host Shortcut Keys - see hid_keys.h
+ */
+
+#include "hid_keys.h"
+#include "ble_hid.h"
+#include "ble_link.h"
+#include "config.h"
+#include <soc/soc_caps.h>
+
+// TinyUSB HID needs the OTG controller; the C3's Serial/JTAG port cannot
+// enumerate as anything else
+#if FEATURE_USB_HID && SOC_USB_OTG_SUPPORTED && !ARDUINO_USB_MODE
+#define HID_KEYS_USB    1
+#include <USB.h>
+#include <USBHID.h>
+#else
+#define HID_KEYS_USB    0
+#endif
+
+const uint8_t hidReportMap[] = {
+    0x05, 0x01,         // Usage Page (Generic Desktop)
+    0x09, 0x06,         // Usage (Keyboard)
+    0xA1, 0x01,         // Collection (Application)
+    0x85, HID_REPORT_ID_KEYS,
+    0x05, 0x07,         //   Usage Page (Keyboard)
+    0x19, 0xE0,         //   Usage Minimum (Left Control)
+    0x29, 0xE7,         //   Usage Maximum (Right GUI)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x25, 0x01,         //   Logical Maximum (1)
+    0x75, 0x01,         //   Report Size (1)
+    0x95, 0x08,         //   Report Count (8)
+    0x81, 0x02,         //   Input (Data, Variable, Absolute): modifiers
+    0x95, 0x01,         //   Report Count (1)
+    0x75, 0x08,         //   Report Size (8)
+    0x81, 0x01,         //   Input (Constant): reserved
+    0x95, 0x06,         //   Report Count (6)
+    0x75, 0x08,         //   Report Size (8)
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x25, 0x65,         //   Logical Maximum (101)
+    0x19, 0x00,         //   Usage Minimum (0)
+    0x29, 0x65,         //   Usage Maximum (101)
+    0x81, 0x00,         //   Input (Data, Array): key codes
+    0xC0,               // End Collection
+
+    0x05, 0x0C,         // Usage Page (Consumer)
+    0x09, 0x01,         // Usage (Consumer Control)
+    0xA1, 0x01,         // Collection (Application)
+    0x85, HID_REPORT_ID_MEDIA,
+    0x15, 0x00,         //   Logical Minimum (0)
+    0x25, 0x01,         //   Logical Maximum (1)
+    0x75, 0x01,         //   Report Size (1)
+    0x95, 0x07,         //   Report Count (7), in HidMediaKey bit order:
+    0x09, 0xCD,         //   Usage (Play/Pause)
+    0x09, 0xB5,         //   Usage (Scan Next Track)
+    0x09, 0xB6,         //   Usage (Scan Previous Track)
+    0x09, 0xB7,         //   Usage (Stop)
+    0x09, 0xE2,         //   Usage (Mute)
+    0x09, 0xE9,         //   Usage (Volume Increment)
+    0x09, 0xEA,         //   Usage (Volume Decrement)
+    0x81, 0x02,         //   Input (Data, Variable, Absolute)
+    0x95, 0x01,         //   Report Count (1)
+    0x81, 0x01,         //   Input (Constant): padding
+    0xC0                // End Collection
+};
+const uint16_t hidReportMapSize = sizeof(hidReportMap);
+
+// Built by the compiler; a typo in a config.h combo fails the build
+static constexpr HidCombo shortcutCombos[HID_SHORTCUT_COUNT] = {
+    hidParseCombo(HID_MUTE_COMBO),
+    hidParseCombo(TEAMS_VIDEO_COMBO),
+    hidParseCombo(DISCORD_DEAFEN_COMBO),
+};
+static_assert(shortcutCombos[HID_SHORTCUT_MUTE].valid, "HID_MUTE_COMBO is not a valid key combo");
+static_assert(shortcutCombos[HID_SHORTCUT_VIDEO].valid, "TEAMS_VIDEO_COMBO is not a valid key combo");
+static_assert(shortcutCombos[HID_SHORTCUT_DEAFEN].valid, "DISCORD_DEAFEN_COMBO is not a valid key combo");
+
+static const HidKeyReport releaseReport = { 0, 0, { 0, 0, 0, 0, 0, 0 } };
+static uint32_t sentCount = 0;
+
+#if HID_KEYS_USB
+class ShortcutHidDevice : public USBHIDDevice {
+public:
+    uint16_t _onGetDescriptor(uint8_t* buffer) override {
+        memcpy(buffer, hidReportMap, hidReportMapSize);
+        return hidReportMapSize;
+    }
+};
+
+static USBHID usbHid;
+static ShortcutHidDevice usbShortcuts;
+
+#endif
+
+static bool sendReport(HidTransport transport, uint8_t reportId, const void* data,
+                       uint8_t length) {
+    switch (transport) {
+#if HID_KEYS_USB
+        case HID_TRANSPORT_USB:
+            // Blocks until the host has polled the report, at most one interval
+            return usbHid.SendReport(reportId, data, length, HID_USB_REPORT_TIMEOUT_MS);
+#endif
+        case HID_TRANSPORT_BLE:
+            return bleHidSendReport(reportId, data, length);
+        default:
+            return false;
+    }
+}
+
+// Press then release, both on the transport chosen for the press
+static bool tap(uint8_t reportId, const void* press, const void* release, uint8_t length) {
+    HidTransport transport = hidKeysTransport();
+    if (transport == HID_TRANSPORT_BLE) {
+        // Leave the idle profile's long interval; the release and any
+        // repeats then go out at the active one
+        bleLinkActivity();
+    }
+    bool ok = sendReport(transport, reportId, press, length) &&
+              sendReport(transport, reportId, release, length);
+    if (ok) {
+        sentCount++;
+    }
+    return ok;
+}
+
+bool hidKeysBegin() {
+#if HID_KEYS_USB
+    usbHid.addDevice(&usbShortcuts, hidReportMapSize);
+    USB.VID(USB_VENDOR_ID);
+    USB.PID(USB_PRODUCT_ID);
+    USB.manufacturerName(USB_MANUFACTURER_STRING);
+    USB.productName(USB_PRODUCT_STRING);
+    usbHid.begin();
+    return USB.begin();
+#else
+    return true;
+#endif
+}
+
+HidTransport hidKeysTransport() {
+#if HID_KEYS_USB
+    if (usbHid.ready()) {
+        return HID_TRANSPORT_USB;
+    }
+#endif
+    return bleHidReady() ? HID_TRANSPORT_BLE : HID_TRANSPORT_NONE;
+}
+
+bool hidKeysSend(HidShortcut shortcut) {
+    if (shortcut >= HID_SHORTCUT_COUNT) {
+        return false;
+    }
+    return tap(HID_REPORT_ID_KEYS, &shortcutCombos[shortcut].report, &releaseReport,
+               sizeof(HidKeyReport));
+}
+
+bool hidKeysSendMedia(HidMediaKey key) {
+    static const uint8_t released = 0;
+    uint8_t pressed = key;
+    return tap(HID_REPORT_ID_MEDIA, &pressed, &released, sizeof(pressed));
+}
+
+uint32_t hidKeysSentCount() {
+    return sentCount;
+}
@@ -0,0 +1,159 @@
+/**
+ * Deferred Binary Log - see log_ring.h
+ */
+
+#include "log_ring.h"
+#include "config.h"
+#include "static_arena.h"
+
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE must be a power of two");
+static_assert(LOG_LEVEL_ERROR == DEBUG_LEVEL_ERROR && LOG_LEVEL_DEBUG == DEBUG_LEVEL_DEBUG,
+              "log levels must match config.h");
+
+#define LOG_LINE_MAX            160
+
+// Bounded multi-producer ring (D. Vyukov). Each cell's turn counter says
+// whether it is free for position `pos` (turn == pos) or holds the record
+// for it (turn == pos + 1). Stored relative to the cell index so the
+// zero-initialized ring is already valid before logRingBegin().
+struct LogRecord {
+    uint32_t turn;
+    const char* format;
+    uint32_t timestampMs;
+    uint8_t level;
+    uint8_t argCount;
+    uint32_t args[LOG_MAX_ARGS];
+};
+
+static LogRecord ring[LOG_RING_SIZE];
+static uint32_t enqueuePos = 0;
+static uint32_t dequeuePos = 0;     // Drain side only
+static uint32_t dropped = 0;
+static uint32_t droppedReported = 0;
+static TaskHandle_t drainTask = nullptr;
+static SemaphoreHandle_t drainMutex = nullptr;     // The ring has one consumer at a time
+
+static inline uint32_t cellTurn(uint32_t index) {
+    return __atomic_load_n(&ring[index].turn, __ATOMIC_ACQUIRE) + index;
+}
+
+static inline void setCellTurn(uint32_t index, uint32_t turn) {
+    __atomic_store_n(&ring[index].turn, turn - index, __ATOMIC_RELEASE);
+}
+
+void logRingPost(uint8_t level, const char* format, const uint32_t* args, uint8_t count) {
+    if (level > DEBUG_LEVEL) {
+        return;
+    }
+
+    uint32_t pos = __atomic_load_n(&enqueuePos, __ATOMIC_RELAXED);
+    uint32_t index;
+    for (;;) {
+        index = pos & (LOG_RING_SIZE - 1);
+        int32_t lag = (int32_t)(cellTurn(index) - pos);
+        if (lag == 0) {
+            if (__atomic_compare_exchange_n(&enqueuePos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (lag < 0) {
+            __atomic_add_fetch(&dropped, 1, __ATOMIC_RELAXED);
+            return;     // Full: the drain task has not reached this cell yet
+        } else {
+            pos = __atomic_load_n(&enqueuePos, __ATOMIC_RELAXED);
+        }
+    }
+
+    LogRecord& record = ring[index];
+    record.format = format;
+    record.timestampMs = millis();
+    record.level = level;
+    record.argCount = count > LOG_MAX_ARGS ? LOG_MAX_ARGS : count;
+    memcpy(record.args, args, record.argCount * sizeof(uint32_t));
+    setCellTurn(index, pos + 1);
+
+    if (!drainTask) {
+        return;
+    }
+    if (xPortInIsrContext()) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(drainTask, &woken);
+        portYIELD_FROM_ISR(woken);
+    } else {
+        xTaskNotifyGive(drainTask);
+    }
+}
+
+// Copy out the oldest complete record, if any
+static bool takeRecord(LogRecord& out) {
+    uint32_t index = dequeuePos & (LOG_RING_SIZE - 1);
+    if (cellTurn(index) != dequeuePos + 1) {
+        return false;   // Empty, or the producer is still writing it
+    }
+    out = ring[index];
+    setCellTurn(index, dequeuePos + LOG_RING_SIZE);
+    dequeuePos++;
+    return true;
+}
+
+static void writeRecord(const LogRecord& record) {
+    uint32_t a[LOG_MAX_ARGS] = {};
+    memcpy(a, record.args, record.argCount * sizeof(uint32_t));
+
+    // Unused trailing arguments are ignored by the formatter; all of them
+    // are register-sized on this target
+    char line[LOG_LINE_MAX];
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-security"
+    snprintf(line, sizeof(line), record.format, a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]);
+#pragma GCC diagnostic pop
+    Serial.printf("%6u.%03u %s\n", record.timestampMs / 1000, record.timestampMs % 1000, line);
+}
+
+static void drain() {
+    if (drainMutex) {
+        xSemaphoreTake(drainMutex, portMAX_DELAY);
+    }
+
+    LogRecord record;
+    while (takeRecord(record)) {
+        writeRecord(record);
+    }
+
+    uint32_t lost = __atomic_load_n(&dropped, __ATOMIC_RELAXED);
+    if (lost != droppedReported) {
+        Serial.printf("log: %u messages dropped\n", lost - droppedReported);
+        droppedReported = lost;
+    }
+
+    if (drainMutex) {
+        xSemaphoreGive(drainMutex);
+    }
+}
+
+static void drainTaskBody(void* param) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        drain();
+    }
+}
+
+bool logRingBegin() {
+    drainMutex = arenaCreateMutex();
+    drainTask = arenaCreateTask(drainTaskBody, "log", LOG_TASK_STACK_SIZE, nullptr,
+                                TASK_PRIORITY_LOW);
+    if (!drainMutex || !drainTask) {
+        return false;
+    }
+    xTaskNotifyGive(drainTask);     // Anything posted before we started
+    return true;
+}
+
+void logRingFlush() {
+    drain();
+}
+
+uint32_t logRingDropped() {
+    return __atomic_load_n(&dropped, __ATOMIC_RELAXED);
+}
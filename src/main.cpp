@@ -11,213 +11,495 @@
 #include <BLEUtils.h>
 #include <BLE2902.h>
 
-// Pin definitions (ESP32-C3 compatible)
-#define PIN_OLED_SDA    8
-#define PIN_OLED_SCL    9
-#define PIN_BAT_ADC     4
-#define PIN_STAT        5
-#define PIN_EN_AUDIO    6
-#define PIN_EN_MIC      7
-#define PIN_BTN_PWR     20
-#define PIN_BTN_VOL_UP  21
-#define PIN_BTN_VOL_DN  0
-#define PIN_BTN_MUTE    1
-#define PIN_QCC_RESET   2
-#define PIN_QCC_UART_TX 10
-#define PIN_QCC_UART_RX 3
+#include "config.h"
+#include "app_tasks.h"
+#include "ble_commands.h"
+#include "ble_status.h"
+#include "audio_capture.h"
+#include "buttons.h"
+#include "display_view.h"
+#include "qcc_link.h"
+#include "power_seq.h"
+#include "battery_monitor.h"
+#include "power_manager.h"
+#include "dsp.h"
+#include "mic_pipeline.h"
+#include "static_arena.h"
+#include "heap_monitor.h"
+#include "profiler.h"
+#include "log_ring.h"
+#include "settings.h"
+#include "hid_keys.h"
+#include "ble_hid.h"
+#include "ble_link.h"
+#include "mic_stream.h"
+#include "telemetry_log.h"
+#include "charger.h"
+#include "ble_ota.h"
+#include "boot_profile.h"
+#include "console.h"
+
+// config.h: EN_MIC and QCC TX are on USB D-/D+ on this board revision
+#if CONFIG_USB_PINS_TAKEN && (PIN_EN_MIC == 18 || PIN_EN_MIC == 19 || \
+                              PIN_QCC_TX == 18 || PIN_QCC_TX == 19)
+#warning "PIN_EN_MIC/PIN_QCC_TX sit on USB D-/D+: the USB console drops once they are set up"
+#endif
 
 // Display
-#define SCREEN_WIDTH 128
-#define SCREEN_HEIGHT 32
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
 
 // BLE HID and Control
 BLEServer* pServer = nullptr;
 BLECharacteristic* pCharacteristic = nullptr;
 
 // State
-uint8_t volume = 8;
+uint8_t volume = QCC_VOLUME_DEFAULT;
 bool muted = false;
 bool connected = false;
 bool audioEnabled = false;
 bool micEnabled = false;
 bool isCharging = false;
 bool chargingComplete = false;
-float batteryPercent = 0;
-uint32_t lastVADCheck = 0;
-bool voiceDetected = false;
-
-// Audio processing
-#define SAMPLE_RATE 16000
-#define FRAME_SIZE 320
-#define VAD_THRESHOLD 0.001f
-float audioBuffer[FRAME_SIZE];
-float energyHistory[10];
-uint8_t historyIndex = 0;
+uint8_t batteryPercent = 0;
+uint8_t noiseReductionLevel = (uint8_t)(NOISE_REDUCTION_LEVEL * 100);   // Percent, set over BLE
+volatile bool voiceDetected = false;  // Written by the audio task
 
 // Function declarations
-void handleButtons();
 void togglePower();
 void volumeUp();
 void volumeDown();
+void setVolume(uint8_t level);
 void toggleMute();
-void updateBattery();
-void updateCharging();
+void stopMic();
+bool updateBattery();
+void chargeChanged(ChargeState state);
 void updateDisplay();
 void sendQCCCommand(uint8_t cmd, uint8_t data = 0);
 void initQCC5124();
+void powerStateChanged(PowerState state);
+void prepareDeepSleep();
 void initBLE();
-void processBLECommand();
-float calculateEnergy(float* buffer, int size);
-bool detectVoice();
-void processAudio();
-
-// QCC5124 Commands
-void initQCC5124();
+void initDisplay();
+void publishBLEStatus();
+void voiceChanged(bool voice);
+void handleControlEvent(const ControlEvent& event);
+void buttonPressed(uint8_t id);
 
 // BLE Callbacks
 class MyServerCallbacks: public BLEServerCallbacks {
     void onConnect(BLEServer* pServer) {
         connected = true;
-        Serial.println("BLE Client Connected");
+        powerManagerLock(PM_LOCK_BLE, true);
+        bleStatusResend();
+        postDisplayEvent();
+        DEBUG_INFO("BLE Client Connected");
+        bootProfileReport();        // Once per boot
+    }
+    
+    void onConnect(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) {
+        bleLinkConnected(param);    // Peer address for the parameter requests
     }
     
     void onDisconnect(BLEServer* pServer) {
         connected = false;
-        Serial.println("BLE Client Disconnected");
-        pServer->startAdvertising(); // Restart advertising
+        powerManagerLock(PM_LOCK_BLE, false);
+        postDisplayEvent();
+        DEBUG_INFO("BLE Client Disconnected");
+        bleLinkDisconnected();      // Advertising restarts with backoff
     }
 };
 
 // Voice Activity Detection
-float calculateEnergy(float* buffer, int size);
-bool detectVoice();
-void processAudio();
+void voiceChanged(bool voice);
 void initBLE();
 
-// Button debouncing
-unsigned long lastButtonPress[4] = {0, 0, 0, 0};
-const unsigned long DEBOUNCE_DELAY = 50;
-
 void setup() {
-    Serial.begin(115200);
+    Serial.begin(DEBUG_SERIAL_SPEED);
+    
+    // Deferred console output; nothing below formats text on its own thread
+    if (!logRingBegin()) {
+        Serial.println("Log task start failed");
+    }
+    bootMark(BOOT_LOG);
     
-    // Initialize pins
-    pinMode(PIN_BTN_PWR, INPUT_PULLUP);
-    pinMode(PIN_BTN_VOL_UP, INPUT_PULLUP);
-    pinMode(PIN_BTN_VOL_DN, INPUT_PULLUP);
-    pinMode(PIN_BTN_MUTE, INPUT_PULLUP);
+    // Clocks, PM locks and sleep; also tells us if this is a deep sleep wake
+    if (!powerManagerBegin(prepareDeepSleep)) {
+        DEBUG_ERROR("Power manager init failed");
+    }
+    
+    // Saved volume, mute and DSP tuning, in one NVS read; the codec gets
+    // them with its first initQCC5124()
+    Settings defaults = { volume, muted, dspThresholdQ30(VAD_THRESHOLD), noiseReductionLevel };
+    settingsBegin(defaults);
+    Settings saved = settingsGet();
+    volume = saved.volume;
+    muted = saved.muted;
+    noiseReductionLevel = saved.nrLevel;
+    
+    // Initialize pins (buttons are configured by buttonsBegin())
     pinMode(PIN_EN_AUDIO, OUTPUT);
     pinMode(PIN_EN_MIC, OUTPUT);
-    pinMode(PIN_QCC_RESET, OUTPUT);
-    pinMode(PIN_STAT, INPUT);
-    
-    // Initialize power control
+    if constexpr (PIN_QCC_RST != PIN_NONE) {
+        pinMode(PIN_QCC_RST, OUTPUT);
+        digitalWrite(PIN_QCC_RST, LOW);     // QCC held in reset
+    }
     digitalWrite(PIN_EN_AUDIO, LOW);  // Audio off initially
     digitalWrite(PIN_EN_MIC, LOW);    // Mic off initially
-    digitalWrite(PIN_QCC_RESET, LOW); // QCC reset
+    bootMark(BOOT_SETTINGS);
     
-    // Initialize I2C and display
-    Wire.begin(PIN_OLED_SDA, PIN_OLED_SCL);
-    if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) {
-        Serial.println("OLED init failed");
+    // Host shortcut keys: native USB HID where the chip has OTG, else BLE HID
+    if constexpr (FEATURE_USB_HID) {
+        if (!hidKeysBegin()) {
+            DEBUG_ERROR("USB HID init failed");
+        }
     }
     
-    display.clearDisplay();
-    display.setTextSize(1);
-    display.setTextColor(WHITE);
-    display.setCursor(0, 0);
-    display.println("ESP32-C3 Headset");
-    display.println("Initializing...");
-    display.display();
+    // BLE first, so the headset is discoverable while the rest comes up;
+    // commands arriving early are dropped until the queues exist
+    if constexpr (FEATURE_BLUETOOTH) {
+        initBLE();
+    }
     
-    // Initialize USB HID - Removed (ESP32-C3 compatibility issues)
-    // USB.begin();
-    // keyboard.begin();
+    // Battery ADC (calibrated, first reading taken here)
+    if constexpr (FEATURE_BATTERY_MONITOR) {
+        if (batteryMonitorBegin(PIN_BAT_ADC)) {
+            batteryPercent = batteryMonitorPercent();
+        } else {
+            DEBUG_ERROR("Battery monitor init failed");
+        }
+    }
+    
+    // Charger STAT edges; transitions arrive as CONTROL_CHARGE_STATE
+    if (chargerBegin(PIN_STAT, chargeChanged)) {
+        isCharging = chargerState() == CHARGE_CHARGING;
+        chargingComplete = chargerState() == CHARGE_CHARGED;
+    }
+    bootMark(BOOT_BATTERY);
     
     // Initialize UART for QCC5124
-    Serial1.begin(115200, SERIAL_8N1, PIN_QCC_UART_RX, PIN_QCC_UART_TX);
+    Serial1.begin(QCC_UART_BAUD, SERIAL_8N1, PIN_QCC_RX, PIN_QCC_TX);
+    if (!qccLinkBegin(&Serial1)) {
+        DEBUG_ERROR("QCC link init failed");
+    }
+    bootMark(BOOT_CODEC_LINK);
+    
+    // Mic processing: stage settings from config.h, tuning from the store
+    micPipelineBegin(saved.vadThresholdQ30, noiseReductionLevel, voiceChanged);
     
-    // Initialize BLE
-    initBLE();
+    // Initialize I2S microphone capture (clocks start with the mic)
+    if (!audioCaptureBegin()) {
+        DEBUG_ERROR("Mic capture init failed");
+    }
+    bootMark(BOOT_MIC);
     
-    // Initialize QCC5124
-    initQCC5124();
+    // Audio rail and QCC5124 are brought up on demand by the sequencer, so
+    // the codec's reset and boot delays never hold up setup()
+    PowerSeqHooks powerHooks = { initQCC5124, powerStateChanged };
+    if (!powerSeqBegin(PIN_EN_AUDIO, PIN_QCC_RST, powerHooks)) {
+        DEBUG_ERROR("Power sequencer init failed");
+    }
     
-    Serial.println("BLE Headset Controller Ready");
+    // Hand over to the prioritized tasks; the display task brings up the
+    // panel and draws the splash on its own
+    if (!appTasksStart()) {
+        DEBUG_ERROR("Task start failed");
+    }
+    bootMark(BOOT_TASKS);
+    
+    // Button edges feed controlQueue, so start after the tasks
+    if (!buttonsBegin(buttonPressed)) {
+        DEBUG_ERROR("Button init failed");
+    }
+    bootMark(BOOT_BUTTONS_READY);
+    
+    // Startup allocations are done; from here on the heap should hold steady
+    arenaSeal();
+    heapMonitorBegin();
+    telemetryLogBegin();
+    bootMark(BOOT_SETUP_DONE);
+    postDisplayEvent();     // Status screen replaces the splash
+    
+    DEBUG_INFO("BLE Headset Controller Ready");
+}
+
+// Display task context, before the first redraw
+void initDisplay() {
+    if constexpr (FEATURE_OLED_DISPLAY) {
+        Wire.begin(PIN_OLED_SDA, PIN_OLED_SCL);
+        if (!display.begin(SSD1306_SWITCHCAPVCC, OLED_I2C_ADDR)) {
+            DEBUG_ERROR("OLED init failed");
+        }
+        
+        display.clearDisplay();
+        display.setTextSize(1);
+        display.setTextColor(WHITE);
+        if (!powerManagerResumed()) {
+            // Waking from deep sleep goes straight to the status screen
+            display.setCursor(0, 0);
+            display.println("ESP32-C3 Headset");
+            display.println("Initializing...");
+        }
+        display.display();
+        displayViewBegin(&display);
+        if (!powerManagerResumed()) {
+            bootMark(BOOT_SPLASH);
+        }
+    }
 }
 
 void loop() {
-    handleButtons();
-    updateBattery();
-    updateCharging();
-    processAudio();
-    processBLECommand();
-    updateDisplay();
-    delay(10);
+    // All work runs in the tasks started by appTasksStart()
+    vTaskDelete(nullptr);
 }
 
-void handleButtons() {
-    unsigned long now = millis();
-    
-    // Power button
-    if (!digitalRead(PIN_BTN_PWR) && (now - lastButtonPress[0] > DEBOUNCE_DELAY)) {
-        lastButtonPress[0] = now;
-        togglePower();
+// Task Bodies
+void audioTask(void* param) {
+    for (;;) {
+        // Sleeps on the I2S DMA event queue; wakes once per completed frame
+        micPipelineRun(portMAX_DELAY);
+    }
+}
+
+void controlTask(void* param) {
+    ControlEvent event;
+    for (;;) {
+        // Sleeps until a button gesture or command arrives
+        if (xQueueReceive(controlQueue, &event, portMAX_DELAY) == pdTRUE) {
+            handleControlEvent(event);
+        }
     }
+}
+
+// Task waiting in displayShutdown(), notified once the panel is off
+static TaskHandle_t volatile shutdownWaiter = nullptr;
+
+void displayTask(void* param) {
+    initDisplay();      // I2C and the splash, off the boot path
     
-    // Volume up
-    if (!digitalRead(PIN_BTN_VOL_UP) && (now - lastButtonPress[1] > DEBOUNCE_DELAY)) {
-        lastButtonPress[1] = now;
-        volumeUp();
+    DisplayEvent event;
+    for (;;) {
+        // Redraw only when something on screen changed; queued refreshes
+        // collapse into one redraw
+        TickType_t wait = portMAX_DELAY;
+        while (xQueueReceive(displayQueue, &event, wait) == pdTRUE) {
+            if (event == DISPLAY_SLEEP || event == DISPLAY_WAKE) {
+                displayViewSetPower(event == DISPLAY_WAKE);
+            } else if (event == DISPLAY_SHUTDOWN) {
+                displayViewSetPower(false);
+                if (shutdownWaiter) {
+                    xTaskNotifyGive(shutdownWaiter);
+                }
+            }
+            wait = 0;
+        }
+        updateDisplay();
+    }
+}
+
+void telemetryTask(void* param) {
+    TickType_t lastWake = xTaskGetTickCount();
+    for (;;) {
+        chargerService(updateBattery());
+        heapMonitorService();
+        publishBLEStatus();
+        bleStatusService(connected);
+        bleLinkService();
+        micStreamService(connected);    // After the status, so control goes first
+        telemetryLogService(connected);
+        powerManagerService();
+        settingsService();
+        consoleService(Serial);
+        
+        static uint32_t lastDspReport = 0;
+        if (micEnabled && millis() - lastDspReport >= 10000) {
+            lastDspReport = millis();
+            MicPipelineStats mic = micPipelineStats();
+            DEBUG_INFO("Mic DSP: %u cycles/frame (peak %u) at %u MHz, pool low %u",
+                       mic.cyclesLast, mic.cyclesPeak, getCpuFrequencyMhz(), mic.poolLowWater);
+        }
+        vTaskDelayUntil(&lastWake, telemetryPeriodTicks);
+    }
+}
+
+void handleControlEvent(const ControlEvent& event) {
+    if (event.type != CONTROL_POWER_STATE && event.type != CONTROL_CHARGE_STATE) {
+        powerManagerActivity();     // User input restarts the idle timeouts
     }
     
-    // Volume down
-    if (!digitalRead(PIN_BTN_VOL_DN) && (now - lastButtonPress[2] > DEBOUNCE_DELAY)) {
-        lastButtonPress[2] = now;
-        volumeDown();
+    switch (event.type) {
+        case CONTROL_BUTTON:
+            break;
+        case CONTROL_SET_VOLUME:
+            setVolume(event.value);
+            postDisplayEvent();
+            publishBLEStatus();
+            return;
+        case CONTROL_SET_MUTE:
+            if (event.id == BLE_MUTE_TOGGLE || (event.id != 0) != muted) {
+                toggleMute();
+            }
+            postDisplayEvent();
+            publishBLEStatus();
+            return;
+        case CONTROL_SET_POWER:
+            if ((event.id != 0) != powerSeqRequested()) {
+                togglePower();
+            }
+            postDisplayEvent();
+            publishBLEStatus();
+            return;
+        case CONTROL_POWER_STATE:
+            powerManagerLock(PM_LOCK_CODEC, event.id != POWER_OFF && event.id != POWER_FAULT);
+            if (event.id == POWER_OFF || event.id == POWER_FAULT) {
+                stopMic();      // After a fault togglePower() has nothing to switch off
+            }
+            audioEnabled = powerSeqCodecUp();   // `connected` stays the BLE link
+            postDisplayEvent();
+            publishBLEStatus();
+            return;
+        case CONTROL_CHARGE_STATE:
+            isCharging = event.id == CHARGE_CHARGING;
+            chargingComplete = event.id == CHARGE_CHARGED;
+            postDisplayEvent();
+            publishBLEStatus();
+            return;
+        case CONTROL_SET_VAD_THRESHOLD: {
+            // Q15 RMS squared is the Q30 energy the detector compares against
+            uint32_t thresholdQ30 = (uint32_t)event.value * event.value;
+            micPipelineSetVadThreshold(thresholdQ30);
+            settingsSetVadThreshold(thresholdQ30);
+            return;
+        }
+        case CONTROL_SET_NR_LEVEL:
+            noiseReductionLevel = event.value;
+            micPipelineSetNrLevel(noiseReductionLevel);
+            settingsSetNrLevel(noiseReductionLevel);
+            return;
+        default:
+            return;
     }
     
-    // Mute
-    if (!digitalRead(PIN_BTN_MUTE) && (now - lastButtonPress[3] > DEBOUNCE_DELAY)) {
-        lastButtonPress[3] = now;
-        toggleMute();
+    // Power needs a hold so it cannot be toggled by a brush against the
+    // cup, a double click is play/pause on the host; volume steps on press
+    // and auto-repeats while held; mute acts on the press edge for the
+    // lowest latency
+    ButtonAction action = (ButtonAction)event.value;
+    switch (event.id) {
+        case BUTTON_PWR:
+            if (action == BUTTON_DOUBLE_CLICK) {
+                hidKeysSendMedia(HID_MEDIA_PLAY_PAUSE);
+                return;
+            }
+            if (action != BUTTON_LONG_PRESS) return;
+            togglePower();
+            break;
+        case BUTTON_VOL_UP:
+            if (action != BUTTON_PRESS && action != BUTTON_REPEAT) return;
+            if (HID_HOST_VOLUME && hidKeysSendMedia(HID_MEDIA_VOLUME_UP)) return;
+            volumeUp();
+            break;
+        case BUTTON_VOL_DN:
+            if (action != BUTTON_PRESS && action != BUTTON_REPEAT) return;
+            if (HID_HOST_VOLUME && hidKeysSendMedia(HID_MEDIA_VOLUME_DOWN)) return;
+            volumeDown();
+            break;
+        case BUTTON_MUTE:
+            if (action != BUTTON_PRESS) return;
+            toggleMute();
+            break;
+        default:
+            return;
+    }
+    postDisplayEvent();
+    publishBLEStatus();
+}
+
+// Button task context, on the accepted press edge: the conferencing
+// shortcut goes to the host before the event reaches the control task
+void buttonPressed(uint8_t id) {
+    if (id == BUTTON_MUTE && (FEATURE_BLE_HID || FEATURE_USB_HID)) {
+        hidKeysSend(HID_SHORTCUT_MUTE);
     }
 }
 
 void togglePower() {
-    audioEnabled = !audioEnabled;
-    digitalWrite(PIN_EN_AUDIO, audioEnabled ? HIGH : LOW);
-    
-    if (audioEnabled) {
-        // Enable QCC5124
-        digitalWrite(PIN_QCC_RESET, HIGH);
-        delay(100);
-        initQCC5124();
-        Serial.println("Audio System ON");
+    if (!powerSeqRequested()) {
+        // Returns at once; rail, reset and codec init are stepped by the
+        // sequencer and reported through powerStateChanged()
+        powerSeqRequest(true);
+        DEBUG_INFO("Audio System powering up");
     } else {
-        // Disable QCC5124
-        digitalWrite(PIN_QCC_RESET, LOW);
-        digitalWrite(PIN_EN_MIC, LOW);
-        micEnabled = false;
-        Serial.println("Audio System OFF");
+        // Rail and QCC5124 go down immediately; queued commands are dropped
+        powerSeqRequest(false);
+        stopMic();
+        DEBUG_INFO("Audio System OFF");
+    }
+}
+
+// Mic rail off, capture stopped and the APB lock released (control task)
+void stopMic() {
+    digitalWrite(PIN_EN_MIC, LOW);
+    micEnabled = false;
+    audioCaptureSetEnabled(false);
+    powerManagerLock(PM_LOCK_AUDIO, false);
+}
+
+// The display task owns the panel and I2C bus; have it blank the panel and
+// wait until it has, or give up after DISPLAY_SHUTDOWN_WAIT_MS
+static void displayShutdown() {
+    if constexpr (FEATURE_OLED_DISPLAY) {
+        if (!displayQueue) {
+            return;
+        }
+        TickType_t wait = MILLIS_TO_TICKS(DISPLAY_SHUTDOWN_WAIT_MS);
+        DisplayEvent event = DISPLAY_SHUTDOWN;
+        ulTaskNotifyTake(pdTRUE, 0);    // Drop a stale notification
+        shutdownWaiter = xTaskGetCurrentTaskHandle();
+        if (xQueueSend(displayQueue, &event, wait) == pdTRUE) {
+            ulTaskNotifyTake(pdTRUE, wait);
+        }
+        shutdownWaiter = nullptr;
     }
-    connected = audioEnabled;
+}
+
+// Telemetry task context right before deep sleep, OTA task context before
+// the restart into a new image
+void prepareDeepSleep() {
+    displayShutdown();
+    settingsFlush();
+    logRingFlush();
+}
+
+// Sequencer (timer task) context: keep it short and let the control task
+// update the application state
+void powerStateChanged(PowerState state) {
+    postControlEvent(CONTROL_POWER_STATE, state);
 }
 
 void volumeUp() {
-    if (volume < 15) {
+    if (volume < QCC_VOLUME_MAX) {
         volume++;
-        sendQCCCommand(0x01, volume); // Volume up command
-        Serial.printf("Volume: %d\n", volume);
+        sendQCCCommand(QCC_CMD_SET_VOLUME, volume); // Coalesces with queued steps
+        settingsSetVolume(volume);
+        DEBUG_INFO("Volume: %d", volume);
     }
 }
 
 void volumeDown() {
     if (volume > 0) {
         volume--;
-        sendQCCCommand(0x02, volume); // Volume down command
-        Serial.printf("Volume: %d\n", volume);
+        sendQCCCommand(QCC_CMD_SET_VOLUME, volume); // Coalesces with queued steps
+        settingsSetVolume(volume);
+        DEBUG_INFO("Volume: %d", volume);
+    }
+}
+
+void setVolume(uint8_t level) {
+    if (level <= QCC_VOLUME_MAX && level != volume) {
+        volume = level;
+        sendQCCCommand(QCC_CMD_SET_VOLUME, volume);
+        settingsSetVolume(volume);
+        DEBUG_INFO("Volume: %d", volume);
     }
 }
 
@@ -227,164 +509,90 @@ void toggleMute() {
     // Toggle microphone power
     micEnabled = !muted && audioEnabled;
     digitalWrite(PIN_EN_MIC, micEnabled ? HIGH : LOW);
-    
-    // Send USB HID mute command - Alternative via BLE
-    if (muted) {
-        // Send mute command via BLE instead of USB HID
-        if (pCharacteristic && connected) {
-            pCharacteristic->setValue("MUTE_ON");
-            pCharacteristic->notify();
-        }
-        Serial.println("Sent BLE mute command");
-    } else {
-        if (pCharacteristic && connected) {
-            pCharacteristic->setValue("MUTE_OFF");
-            pCharacteristic->notify();
-        }
-        Serial.println("Sent BLE unmute command");
+    if (micEnabled) {
+        micPipelineReset();     // Fresh noise floor and gain for this session
     }
+    audioCaptureSetEnabled(micEnabled);
+    powerManagerLock(PM_LOCK_AUDIO, micEnabled);
+    
+    // The status record carries the mute flag; text-compat clients also
+    // get MUTE_ON/MUTE_OFF. The host shortcut went out from buttonPressed().
+    bleStatusNotifyMute(muted, connected);
     
     // Send mute command to QCC5124
-    sendQCCCommand(0x03, muted ? 1 : 0);
+    sendQCCCommand(QCC_CMD_MUTE, muted ? 1 : 0);
+    settingsSetMuted(muted);
     
-    Serial.println(muted ? "Muted (Mic OFF)" : "Unmuted (Mic ON)");
+    DEBUG_INFO("%s", muted ? "Muted (Mic OFF)" : "Unmuted (Mic ON)");
 }
 
-void updateBattery() {
-    static unsigned long lastUpdate = 0;
-    if (millis() - lastUpdate > 1000) {
-        lastUpdate = millis();
-        int adcValue = analogRead(PIN_BAT_ADC);
-        // Convert ADC reading to battery percentage (3.0V-4.2V range)
-        float voltage = (adcValue / 4095.0f) * 3.3f * 2.0f; // Voltage divider
-        batteryPercent = map(voltage * 100, 300, 420, 0, 100);
-        batteryPercent = constrain(batteryPercent, 0, 100);
+// Returns true when a new reading was taken
+bool updateBattery() {
+    // Samples only every BAT_CHECK_INTERVAL_MS; filtered and calibrated
+    if constexpr (FEATURE_BATTERY_MONITOR) {
+        if (batteryMonitorUpdate()) {
+            uint8_t percent = batteryMonitorPercent();
+            if (percent != batteryPercent) {
+                batteryPercent = percent;
+                postDisplayEvent();
+            }
+            return true;
+        }
     }
+    return false;
 }
 
-void updateCharging() {
-    static unsigned long lastUpdate = 0;
-    if (millis() - lastUpdate > 500) {
-        lastUpdate = millis();
-        
-        // Read TP4056 STAT pin (LOW = charging, HIGH = complete/standby)
-        bool statPin = digitalRead(PIN_STAT);
-        
-        if (!statPin && batteryPercent < 95) {
-            isCharging = true;
-            chargingComplete = false;
-        } else if (batteryPercent >= 95) {
-            isCharging = false;
-            chargingComplete = true;
-        } else {
-            isCharging = false;
-            chargingComplete = false;
-        }
-    }
+// Timer task context, on a charger state transition
+void chargeChanged(ChargeState state) {
+    postControlEvent(CONTROL_CHARGE_STATE, state);
 }
 
 void updateDisplay() {
-    static unsigned long lastUpdate = 0;
-    if (millis() - lastUpdate > 100) {
-        lastUpdate = millis();
-        
-        display.clearDisplay();
-        display.setTextSize(1);
-        display.setTextColor(WHITE);
-        
-        // Title
-        display.setCursor(0, 0);
-        display.println("ESP32-C3 Headset");
-        
-        // Battery status
-        display.setCursor(0, 10);
-        if (isCharging) {
-            display.printf("Battery: Charging");
-        } else if (chargingComplete) {
-            display.printf("Battery: Full");
-        } else {
-            display.printf("Battery: %.0f%%", batteryPercent);
-        }
-        
-        // Status
-        display.setCursor(0, 20);
-        display.printf("Vol:%d %s %s", 
-                      volume, 
-                      muted ? "MUTE" : (voiceDetected ? "VOICE" : ""),
-                      connected ? "CONN" : "DISC");
-        
-        display.display();
-    }
+    // Paced by the display task; the view only sends pages that changed
+    DisplayState state;
+    state.volume = volume;
+    state.batteryPercent = batteryPercent;
+    state.muted = muted;
+    state.voice = voiceDetected;
+    state.connected = connected;
+    state.charging = isCharging;
+    state.chargeComplete = chargingComplete;
+    displayViewRender(state);
 }
 
 // QCC5124 Communication
 void sendQCCCommand(uint8_t cmd, uint8_t data) {
-    if (audioEnabled) {
-        Serial1.write(0xFF); // Start byte
-        Serial1.write(cmd);
-        Serial1.write(data);
-        Serial1.write(0xFE); // End byte
+    if (powerSeqCodecUp()) {
+        // Queued; the link task frames, sends and retries until ACKed
+        qccLinkSubmit(cmd, data);
     }
 }
 
 void initQCC5124() {
-    delay(100);
-    sendQCCCommand(0x00, 0x01); // Initialize
-    delay(50);
-    sendQCCCommand(0x01, volume); // Set volume
-    delay(50);
-    sendQCCCommand(0x04, 0x01); // Enable A2DP
+    // Called by the sequencer right after it queued INIT; the link sends
+    // these in order behind it, and the sequencer enables A2DP once INIT
+    // has been ACKed
+    sendQCCCommand(QCC_CMD_SET_VOLUME, volume);
+    sendQCCCommand(QCC_CMD_MUTE, muted ? 1 : 0);
 }
 
 // Audio Processing
-float calculateEnergy(float* buffer, int size) {
-    float energy = 0.0f;
-    for (int i = 0; i < size; i++) {
-        energy += buffer[i] * buffer[i];
-    }
-    return sqrt(energy / size);
-}
-
-bool detectVoice() {
-    // Simple VAD based on energy threshold
-    float avgEnergy = 0.0f;
-    for (int i = 0; i < 10; i++) {
-        avgEnergy += energyHistory[i];
-    }
-    avgEnergy /= 10.0f;
-    
-    return avgEnergy > VAD_THRESHOLD;
-}
-
-void processAudio() {
-    if (millis() - lastVADCheck > 20) { // 50Hz VAD check
-        lastVADCheck = millis();
-        
-        if (micEnabled) {
-            // Simulate audio input (replace with actual I2S/ADC reading)
-            float energy = random(0, 1000) / 1000000.0f;
-            
-            energyHistory[historyIndex] = energy;
-            historyIndex = (historyIndex + 1) % 10;
-            
-            voiceDetected = detectVoice();
-            
-            // Only enable mic output when voice is detected
-            if (!voiceDetected && !muted) {
-                // Could add actual mic gating here
-            }
-        }
-    }
+// Audio task context, on every VAD decision change
+void voiceChanged(bool voice) {
+    voiceDetected = voice;
+    postDisplayEvent();
 }
 
 // BLE Initialization
 void initBLE() {
-    BLEDevice::init("ESP32-C3-Headset");
+    BLEDevice::init(BT_DEVICE_NAME);
     pServer = BLEDevice::createServer();
-    pServer->setCallbacks(new MyServerCallbacks());
+    static MyServerCallbacks serverCallbacks;
+    pServer->setCallbacks(&serverCallbacks);
     
-    // Create BLE service for headset control
-    BLEService *pService = pServer->createService("12345678-1234-1234-1234-123456789abc");
+    // Create BLE service for headset control, with handles for the
+    // control, diagnostics, stream, telemetry and boot characteristics
+    BLEService *pService = pServer->createService(BLEUUID("12345678-1234-1234-1234-123456789abc"), 24);
     
     // Create characteristic for volume/control commands
     pCharacteristic = pService->createCharacteristic(
@@ -394,24 +602,54 @@ void initBLE() {
         BLECharacteristic::PROPERTY_NOTIFY
     );
     
+    bleStatusBegin(pCharacteristic);
+    bleCommandsBegin(pCharacteristic);
+    profilerDiagnosticsBegin(pService);
+    micStreamBegin(pService);
+    telemetryLogBleBegin(pService);
+    bootProfileBleBegin(pService);
+    
     pService->start();
     
-    // Start advertising
+    // Keyboard/media HID and the Battery Service, handled natively by the host
+    if constexpr (FEATURE_BLE_HID) {
+        if (!bleHidBegin(pServer)) {
+            DEBUG_ERROR("BLE HID init failed");
+        }
+    }
+    
+    // Firmware updates into the inactive app slot; settings and logs are
+    // flushed before the restart
+    if (!bleOtaBegin(pServer, prepareDeepSleep)) {
+        DEBUG_ERROR("BLE OTA init failed");
+    }
+    
+    bootMark(BOOT_BLE);
+    
+    // Start advertising; intervals, MTU and connection profiles are
+    // managed by the link manager from here on
     BLEAdvertising *pAdvertising = BLEDevice::getAdvertising();
     pAdvertising->addServiceUUID("12345678-1234-1234-1234-123456789abc");
-    pAdvertising->setScanResponse(false);
-    pAdvertising->setMinPreferred(0x0);
-    BLEDevice::startAdvertising();
+    pAdvertising->setScanResponse(true);    // Name moves out of the full advertising packet
+    bleLinkBegin(pServer);
+    bootMark(BOOT_ADVERTISING);
     
-    Serial.println("BLE Headset Controller started, waiting for connections...");
+    DEBUG_INFO("BLE Headset Controller started, waiting for connections...");
 }
 
 // Bluetooth Audio Callbacks (Replaced with BLE control)
-void processBLECommand() {
-    if (pCharacteristic && connected) {
-        // Send status updates via BLE
-        String status = String(volume) + "," + String(muted) + "," + String(batteryPercent);
-        pCharacteristic->setValue(status.c_str());
-        pCharacteristic->notify();
-    }
+void publishBLEStatus() {
+    // Only notifies when a field changed; bursts are coalesced
+    BleStatus status;
+    status.volume = volume;
+    status.batteryPercent = batteryPercent;
+    status.flags = (muted ? BLE_STATUS_MUTED : 0) |
+                   (voiceDetected ? BLE_STATUS_VOICE : 0) |
+                   (isCharging ? BLE_STATUS_CHARGING : 0) |
+                   (chargingComplete ? BLE_STATUS_CHARGED : 0) |
+                   (audioEnabled ? BLE_STATUS_AUDIO_ON : 0) |
+                   (powerSeqState() == POWER_FAULT ? BLE_STATUS_POWER_FAULT : 0) |
+                   (heapMonitorLow() ? BLE_STATUS_LOW_MEMORY : 0);
+    bleStatusUpdate(status, connected);
+    bleHidSetBattery(batteryPercent, connected);
 }
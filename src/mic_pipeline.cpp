@@ -0,0 +1,172 @@
+/**
+ * Microphone Processing Pipeline - see mic_pipeline.h
+ */
+
+#include "mic_pipeline.h"
+#include "config.h"
+#include "mic_config.h"
+#include "audio_capture.h"
+#include "audio_pipeline.h"
+#include "vad.h"
+#include "noise_suppressor.h"
+#include "agc.h"
+#include "mic_stream.h"
+#include "profiler.h"
+
+typedef AudioFrame<AUDIO_FRAME_SIZE> MicFrame;
+
+// Stages
+
+struct VadStage {
+    Vad vad;
+    void process(MicFrame& frame) {
+        PROFILE_SCOPE(PROF_VAD);
+        if (vadProcess(vad, frame.samples, MicFrame::size)) {
+            frame.flags |= AUDIO_FRAME_VOICE;
+        }
+    }
+};
+
+struct NoiseStage {
+    NoiseSuppressor ns;
+    void process(MicFrame& frame) {
+        PROFILE_SCOPE(PROF_NOISE);
+        // The noise estimate learns while the VAD is closed
+        nsProcess(ns, frame.samples, frame.samples, frame.flags & AUDIO_FRAME_VOICE);
+    }
+};
+
+struct AgcStage {
+    Agc agc;
+    void process(MicFrame& frame) {
+        PROFILE_SCOPE(PROF_AGC);
+        agcProcess(agc, frame.samples, MicFrame::size, frame.flags & AUDIO_FRAME_VOICE);
+    }
+};
+
+// Sinks
+
+struct VoiceSink {
+    bool voice;
+    VoiceChangeCallback callback;
+    void process(MicFrame& frame) {
+        bool now = frame.flags & AUDIO_FRAME_VOICE;
+        if (now != voice) {
+            voice = now;
+            if (callback) {
+                callback(now);
+            }
+        }
+    }
+};
+
+// Processed audio to the BLE stream; idle unless a host subscribed
+struct StreamSink {
+    void process(MicFrame& frame) {
+        PROFILE_SCOPE(PROF_MIC_STREAM);
+        micStreamProcess(frame.samples, MicFrame::size);
+    }
+};
+
+static FramePool<MicFrame, MIC_FRAME_POOL_SIZE> framePool;
+static StageSlot<FEATURE_VAD, VadStage> vadSlot;
+static StageSlot<FEATURE_NOISE_REDUCTION, NoiseStage> nrSlot;
+static StageSlot<FEATURE_AGC, AgcStage> agcSlot;
+static VoiceSink voiceSink;
+static StageSlot<FEATURE_MIC_STREAM, StreamSink> streamSlot;
+
+static volatile bool resetPending = false;
+static uint32_t sequence = 0;
+static MicPipelineStats stats;
+
+static void resetStages() {
+    if (VadStage* s = vadSlot.get()) vadReset(s->vad);
+    if (NoiseStage* s = nrSlot.get()) nsReset(s->ns);
+    if (AgcStage* s = agcSlot.get()) agcReset(s->agc);
+}
+
+void micPipelineBegin(uint32_t vadThresholdQ30, uint8_t nrLevel,
+                      VoiceChangeCallback onVoiceChange) {
+    if (VadStage* s = vadSlot.get()) {
+        vadInit(s->vad, vadConfig);
+        vadSetThreshold(s->vad, vadThresholdQ30);
+    }
+    if (NoiseStage* s = nrSlot.get()) {
+        nsInit(s->ns, nsConfig);
+        nsSetLevel(s->ns, nrLevel);
+    }
+    if (AgcStage* s = agcSlot.get()) {
+        agcInit(s->agc, agcConfig);
+    }
+    voiceSink.voice = false;
+    voiceSink.callback = onVoiceChange;
+
+    DEBUG_INFO("mic pipeline: %u frame pool bytes, VAD %d NR %d AGC %d",
+               (unsigned)framePool.bytes(), vadSlot.enabled, nrSlot.enabled, agcSlot.enabled);
+}
+
+bool micPipelineRun(TickType_t timeout) {
+    MicFrame* frame = framePool.acquire();
+    if (!frame) {
+        // Every frame is still held by a sink; let them drain
+        stats.poolExhausted = framePool.exhausted();
+        vTaskDelay(1);
+        return false;
+    }
+
+    // Source: the DMA descriptor lands directly in the pool frame
+    if (!audioCaptureRead(frame->samples, timeout)) {
+        framePool.release(frame);
+        return false;
+    }
+    frame->sequence = sequence++;
+
+    if (resetPending) {
+        resetPending = false;
+        resetStages();
+    }
+
+    uint32_t start = ESP.getCycleCount();
+    {
+        PROFILE_SCOPE(PROF_MIC_FRAME);
+        runStages(*frame, vadSlot, nrSlot, agcSlot);
+    }
+    uint32_t cycles = ESP.getCycleCount() - start;
+
+    runStages(*frame, voiceSink, streamSlot);
+    bool voice = frame->flags & AUDIO_FRAME_VOICE;
+    framePool.release(frame);
+
+    stats.frames++;
+    if (voice) {
+        stats.voiceFrames++;
+    }
+    stats.cyclesLast = cycles;
+    if (cycles > stats.cyclesPeak) {
+        stats.cyclesPeak = cycles;
+    }
+    return true;
+}
+
+void micPipelineReset() {
+    resetPending = true;
+}
+
+void micPipelineSetVadThreshold(uint32_t thresholdQ30) {
+    if (VadStage* s = vadSlot.get()) {
+        vadSetThreshold(s->vad, thresholdQ30);
+    }
+}
+
+void micPipelineSetNrLevel(uint8_t percent) {
+    if (NoiseStage* s = nrSlot.get()) {
+        nsSetLevel(s->ns, percent);
+    }
+}
+
+MicPipelineStats micPipelineStats() {
+    MicPipelineStats snapshot = stats;
+    snapshot.poolLowWater = framePool.lowWater();
+    snapshot.poolExhausted = framePool.exhausted();
+    return snapshot;
+}
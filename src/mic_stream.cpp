@@ -0,0 +1,147 @@
+/**
+ * Mic Audio Streaming over BLE - see mic_stream.h
+ */
+
+#include "mic_stream.h"
+#include "config.h"
+#include "adpcm.h"
+#include "ble_link.h"
+#include "spsc_ring.h"
+#include <BLEServer.h>
+#include <BLE2902.h>
+
+#define MIC_STREAM_UUID         "87654321-4321-4321-4321-cba987654323"
+#define ATT_NOTIFY_OVERHEAD     3
+#define PACKET_MAX              (BT_LINK_MTU - ATT_NOTIFY_OVERHEAD)
+
+struct StreamPacket {
+    uint8_t length;
+    uint8_t data[PACKET_MAX];
+};
+
+static_assert(PACKET_MAX <= 255, "Packet length is a u8");
+
+static BLECharacteristic* streamCharacteristic = nullptr;
+static BLE2902* streamCccd = nullptr;
+
+// Audio task produces, telemetry task consumes; packets never get copied.
+// Two slots when the feature is off, so release builds keep the RAM.
+static SpscRing<StreamPacket, FEATURE_MIC_STREAM ? MIC_STREAM_QUEUE_DEPTH : 2> packets;
+static StreamPacket overflow;           // Encoded into and discarded when full
+
+// Written by the telemetry task, followed by the audio task
+static volatile uint16_t requestedPayload = 0;
+
+// Audio task state
+static uint16_t payloadBytes = 0;
+static AdpcmState encoder;
+static StreamPacket* packet = nullptr;  // Slot being filled
+static uint16_t fill = 0;               // ADPCM bytes in `packet`
+static uint16_t sequence = 0;
+static uint8_t nextFlags = 0;
+
+static uint32_t packetsSent = 0;
+static uint32_t packetsDropped = 0;
+
+static void openPacket() {
+    if (!packets.writeSpan(&packet)) {
+        packet = &overflow;
+    }
+    MicStreamHeader header;
+    header.sequence = sequence;
+    header.predictor = encoder.predictor;
+    header.stepIndex = encoder.stepIndex;
+    header.flags = nextFlags;
+    memcpy(packet->data, &header, sizeof(header));
+    nextFlags = 0;
+}
+
+static void closePacket() {
+    packet->length = (uint8_t)(sizeof(MicStreamHeader) + fill);
+    if (packet == &overflow) {
+        packetsDropped++;
+    } else {
+        packets.commitWrite(1);
+    }
+    sequence++;         // Also for a dropped packet, so the host sees the gap
+    fill = 0;
+}
+
+void micStreamBegin(BLEService* service) {
+    if constexpr (!FEATURE_MIC_STREAM) {
+        return;
+    }
+    streamCharacteristic = service->createCharacteristic(MIC_STREAM_UUID,
+                                                         BLECharacteristic::PROPERTY_NOTIFY);
+    static BLE2902 cccd;
+    streamCccd = &cccd;
+    streamCharacteristic->addDescriptor(streamCccd);
+}
+
+void micStreamProcess(const int16_t* samples, size_t count) {
+    uint16_t requested = requestedPayload;
+    if (requested != payloadBytes) {
+        // (Re)start on a packet boundary with a fresh encoder
+        payloadBytes = requested;
+        adpcmReset(encoder);
+        fill = 0;
+        nextFlags = MIC_STREAM_FLAG_START;
+    }
+    if (!payloadBytes) {
+        return;
+    }
+
+    size_t done = 0;
+    while (done < count) {
+        if (fill == 0) {
+            openPacket();
+        }
+        size_t samplesFree = (size_t)(payloadBytes - fill) * 2;
+        size_t n = count - done < samplesFree ? count - done : samplesFree;
+        adpcmEncode(encoder, samples + done, n,
+                    &packet->data[sizeof(MicStreamHeader) + fill]);
+        fill += n / 2;
+        done += n;
+        if (fill == payloadBytes) {
+            closePacket();
+        }
+    }
+}
+
+void micStreamService(bool connected) {
+    if (!streamCharacteristic) {
+        return;
+    }
+
+    uint16_t mtu = bleLinkMtu();
+    bool wanted = connected && streamCccd->getNotifications() && mtu >= MIC_STREAM_MIN_MTU;
+    uint16_t packetBytes = mtu - ATT_NOTIFY_OVERHEAD < PACKET_MAX ?
+                           mtu - ATT_NOTIFY_OVERHEAD : PACKET_MAX;
+    uint16_t payload = wanted ? packetBytes - sizeof(MicStreamHeader) : 0;
+    if (payload != requestedPayload) {
+        requestedPayload = payload;
+        // Short connection interval for the stream's throughput
+        bleLinkHoldActive(BLE_LINK_HOLD_MIC_STREAM, payload != 0);
+        if (!payload) {
+            packets.clear();    // Stale audio from before the stop
+        }
+        DEBUG_INFO("mic stream %s, %u byte packets", payload ? "on" : "off",
+                   (unsigned)packetBytes);
+    }
+
+    const StreamPacket* out;
+    for (uint8_t i = 0; i < MIC_STREAM_BURST && packets.peek(&out); i++) {
+        streamCharacteristic->setValue((uint8_t*)out->data, out->length);
+        streamCharacteristic->notify();     // Copies into the stack's buffer
+        packets.commitRead(1);
+        packetsSent++;
+    }
+}
+
+MicStreamStats micStreamStats() {
+    MicStreamStats stats;
+    stats.packetsSent = packetsSent;
+    stats.packetsDropped = packetsDropped;
+    stats.payloadBytes = payloadBytes;
+    return stats;
+}
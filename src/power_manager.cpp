@@ -0,0 +1,246 @@
+/**
+ * CPU Power Manager - see power_manager.h
+ */
+
+#include "power_manager.h"
+#include "config.h"
+#include "static_arena.h"
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+#include <sys/time.h>
+
+#define PM_RTC_MAGIC            0x504D5231  // "PMR1": residency block is valid
+
+#if defined(ARDUINO) && !POWER_LIGHT_SLEEP
+#warning "CONFIG_PM_ENABLE / CONFIG_FREERTOS_USE_TICKLESS_IDLE not set: no light sleep or PM locks"
+#endif
+
+// Residency survives deep sleep; cleared on every other reset
+RTC_DATA_ATTR static uint32_t rtcMagic;
+RTC_DATA_ATTR static uint64_t residencyUs[PM_MODE_COUNT];
+RTC_DATA_ATTR static struct timeval sleptAt;
+
+static const char* const modeNames[] = { "ACTIVE", "IDLE", "POWER_SAVE", "DEEP_SLEEP" };
+static const char* const lockNames[] = { "audio", "codec", "ble" };
+
+static SemaphoreHandle_t pmMutex = nullptr;
+static PowerSleepCallback sleepCallback = nullptr;
+static uint8_t heldLocks = 0;
+static PowerMode mode = PM_MODE_IDLE;
+static int64_t modeSinceUs = 0;
+static uint32_t lastActivity = 0;
+static bool resumed = false;
+
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t pmLocks[PM_LOCK_COUNT];
+
+static bool configureFrequency(int maxMhz) {
+    esp_pm_config_esp32c3_t pmConfig = {};
+    pmConfig.max_freq_mhz = maxMhz;
+    pmConfig.min_freq_mhz = POWER_CPU_FREQ_MIN;
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    pmConfig.light_sleep_enable = true;
+#endif
+    esp_err_t err = esp_pm_configure(&pmConfig);
+    if (err != ESP_OK) {
+        DEBUG_ERROR("esp_pm_configure(%d MHz) failed: %d", maxMhz, err);
+        return false;
+    }
+    return true;
+}
+#else
+static bool configureFrequency(int maxMhz) {
+    // No DFS in this build: run at the cap directly
+    return setCpuFrequencyMhz(maxMhz);
+}
+#endif
+
+static uint64_t buttonWakeMask() {
+    static const uint8_t pins[] = { PIN_BTN_PWR, PIN_BTN_VOL_UP, PIN_BTN_VOL_DN, PIN_BTN_MUTE };
+    uint64_t mask = 0;
+    for (uint8_t i = 0; i < ARRAY_SIZE(pins); i++) {
+        if (esp_sleep_is_valid_wakeup_gpio((gpio_num_t)pins[i])) {
+            mask |= 1ULL << pins[i];
+        }
+    }
+    return mask;
+}
+
+// Caller holds pmMutex
+static void setMode(PowerMode next) {
+    if (next == mode) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    residencyUs[mode] += now - modeSinceUs;
+    modeSinceUs = now;
+
+    if (next == PM_MODE_POWER_SAVE) {
+        configureFrequency(POWER_CPU_FREQ_IDLE);
+    } else if (mode == PM_MODE_POWER_SAVE) {
+        configureFrequency(POWER_CPU_FREQ_ACTIVE);
+    }
+    mode = next;
+    DEBUG_DEBUG("power mode %s", modeNames[next]);
+}
+
+// Caller holds pmMutex
+static void evaluate() {
+    if (heldLocks) {
+        setMode(PM_MODE_ACTIVE);
+    } else if (millis() - lastActivity >= POWER_SAVE_TIMEOUT_MS) {
+        setMode(PM_MODE_POWER_SAVE);
+    } else {
+        setMode(PM_MODE_IDLE);
+    }
+}
+
+// Called without pmMutex held
+static void enterDeepSleep() {
+    uint64_t mask = POWER_WAKE_ON_BUTTON ? buttonWakeMask() : 0;
+    if (!mask) {
+        DEBUG_WARN("no wake-capable button pin, staying out of deep sleep");
+        xSemaphoreTake(pmMutex, portMAX_DELAY);
+        lastActivity = millis();    // Ask again after another full timeout
+        xSemaphoreGive(pmMutex);
+        return;
+    }
+
+    DEBUG_INFO("entering deep sleep");
+    if (sleepCallback) {
+        sleepCallback();
+    }
+
+    residencyUs[mode] += esp_timer_get_time() - modeSinceUs;
+    gettimeofday(&sleptAt, nullptr);
+
+#if SOC_GPIO_SUPPORT_DEEPSLEEP_WAKEUP
+    esp_deep_sleep_enable_gpio_wakeup(mask, ESP_GPIO_WAKEUP_GPIO_LOW);
+#else
+    esp_sleep_enable_ext1_wakeup(mask, ESP_EXT1_WAKEUP_ALL_LOW);
+#endif
+    esp_deep_sleep_disable_rom_logging();   // Shorter wake-up
+    esp_deep_sleep_start();
+}
+
+bool powerManagerBegin(PowerSleepCallback beforeDeepSleep) {
+    sleepCallback = beforeDeepSleep;
+
+    resumed = esp_reset_reason() == ESP_RST_DEEPSLEEP && rtcMagic == PM_RTC_MAGIC;
+    if (resumed) {
+        struct timeval now;
+        gettimeofday(&now, nullptr);
+        residencyUs[PM_MODE_DEEP_SLEEP] += (uint64_t)(now.tv_sec - sleptAt.tv_sec) * 1000000ULL +
+                                           (now.tv_usec - sleptAt.tv_usec);
+    } else {
+        memset(residencyUs, 0, sizeof(residencyUs));
+        rtcMagic = PM_RTC_MAGIC;
+    }
+
+    pmMutex = arenaCreateMutex();
+    if (!pmMutex) {
+        return false;
+    }
+
+#if CONFIG_PM_ENABLE
+    static const esp_pm_lock_type_t lockTypes[PM_LOCK_COUNT] = {
+        ESP_PM_APB_FREQ_MAX,    // AUDIO
+        ESP_PM_APB_FREQ_MAX,    // CODEC
+        ESP_PM_CPU_FREQ_MAX,    // BLE
+    };
+    for (uint8_t i = 0; i < PM_LOCK_COUNT; i++) {
+        if (esp_pm_lock_create(lockTypes[i], 0, lockNames[i], &pmLocks[i]) != ESP_OK) {
+            DEBUG_ERROR("PM lock %u creation failed", i);
+            return false;
+        }
+    }
+#endif
+
+    // Light sleep is left on a button level (see buttons.cpp)
+    if (POWER_WAKE_ON_BUTTON && POWER_LIGHT_SLEEP) {
+        esp_sleep_enable_gpio_wakeup();
+    }
+    if (!POWER_LIGHT_SLEEP) {
+        DEBUG_WARN("built without PM/tickless idle: no light sleep, PM locks inactive");
+    }
+
+    xSemaphoreTake(pmMutex, portMAX_DELAY);
+    modeSinceUs = esp_timer_get_time();
+    lastActivity = millis();
+    mode = PM_MODE_IDLE;
+    xSemaphoreGive(pmMutex);
+    return configureFrequency(POWER_CPU_FREQ_ACTIVE);
+}
+
+void powerManagerLock(PowerLock lock, bool held) {
+    if (!pmMutex || lock >= PM_LOCK_COUNT) {
+        return;
+    }
+    xSemaphoreTake(pmMutex, portMAX_DELAY);
+    uint8_t bit = 1 << lock;
+    if (held != ((heldLocks & bit) != 0)) {
+#if CONFIG_PM_ENABLE
+        if (held) {
+            esp_pm_lock_acquire(pmLocks[lock]);
+        } else {
+            esp_pm_lock_release(pmLocks[lock]);
+        }
+#endif
+        heldLocks = held ? (heldLocks | bit) : (heldLocks & ~bit);
+        if (!held) {
+            lastActivity = millis();    // Idle timeout counts from the release
+        }
+        evaluate();
+    }
+    xSemaphoreGive(pmMutex);
+}
+
+void powerManagerActivity() {
+    if (!pmMutex) {
+        return;
+    }
+    xSemaphoreTake(pmMutex, portMAX_DELAY);
+    lastActivity = millis();
+    evaluate();
+    xSemaphoreGive(pmMutex);
+}
+
+void powerManagerService() {
+    if (!pmMutex) {
+        return;
+    }
+    xSemaphoreTake(pmMutex, portMAX_DELAY);
+    evaluate();
+    bool sleepDue = mode == PM_MODE_POWER_SAVE &&
+                    millis() - lastActivity >= POWER_DEEP_SLEEP_MS;
+    xSemaphoreGive(pmMutex);
+
+    if (sleepDue) {
+        enterDeepSleep();
+    }
+}
+
+PowerMode powerManagerMode() {
+    return mode;
+}
+
+const char* powerManagerModeName(PowerMode m) {
+    return m < PM_MODE_COUNT ? modeNames[m] : "?";
+}
+
+uint32_t powerManagerResidencyMs(PowerMode m) {
+    if (m >= PM_MODE_COUNT) {
+        return 0;
+    }
+    uint64_t us = residencyUs[m];
+    if (m == mode && pmMutex) {
+        us += esp_timer_get_time() - modeSinceUs;
+    }
+    return (uint32_t)(us / 1000);
+}
+
+bool powerManagerResumed() {
+    return resumed;
+}
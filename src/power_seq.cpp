@@ -0,0 +1,177 @@
+/**
+ * Asynchronous Audio Power-Up Sequencer - see power_seq.h
+ */
+
+#include "power_seq.h"
+#include "config.h"
+#include "qcc_link.h"
+#include "static_arena.h"
+
+// Result of a codec command awaited by the sequencer
+enum CodecResult : uint8_t { CODEC_PENDING = 0, CODEC_OK, CODEC_FAILED };
+
+static uint8_t rail = 0;
+static uint8_t reset = 0;
+static PowerSeqHooks seqHooks = {};
+static TimerHandle_t seqTimer = nullptr;
+
+static volatile PowerState state = POWER_OFF;
+static uint32_t stateEnteredAt = 0;
+static uint32_t requestedAt = 0;
+static uint32_t timeToReadyMs = 0;
+
+static volatile CodecResult initResult = CODEC_PENDING;
+static volatile CodecResult a2dpResult = CODEC_PENDING;
+
+static const char* const stateNames[] = {
+    "OFF", "RAIL_ENABLE", "RESET_RELEASE", "CODEC_INIT", "A2DP_ENABLE", "READY", "FAULT"
+};
+
+// The reset line is optional; without one the codec resets with the rail
+static void setReset(uint8_t level) {
+    if (reset != PIN_NONE) {
+        digitalWrite(reset, level);
+    }
+}
+
+static void enterState(PowerState next) {
+    state = next;
+    stateEnteredAt = millis();
+    DEBUG_INFO("audio power: %s", stateNames[next]);
+    if (seqHooks.stateChanged) {
+        seqHooks.stateChanged(next);
+    }
+}
+
+static void codecComplete(uint8_t cmd, bool ok) {
+    // Link task context; the timer task picks the result up on its next poll
+    if (cmd == QCC_CMD_INIT) {
+        initResult = ok ? CODEC_OK : CODEC_FAILED;
+    } else if (cmd == QCC_CMD_A2DP_ENABLE) {
+        a2dpResult = ok ? CODEC_OK : CODEC_FAILED;
+    }
+}
+
+static void fault(const char* reason) {
+    DEBUG_ERROR("audio power-up failed in %s: %s", stateNames[state], reason);
+    xTimerStop(seqTimer, 0);
+    // Nothing stays powered in FAULT, so the next request starts from scratch
+    qccLinkReset();
+    setReset(LOW);
+    digitalWrite(rail, LOW);
+    enterState(POWER_FAULT);
+}
+
+// Timer task: advance the sequence when the current state is done
+static void seqStep(TimerHandle_t timer) {
+    uint32_t elapsed = millis() - stateEnteredAt;
+
+    switch (state) {
+        case POWER_RAIL_ENABLE:
+            if (elapsed >= POWER_RAIL_SETTLE_MS) {
+                setReset(HIGH);
+                enterState(POWER_RESET_RELEASE);
+            }
+            break;
+
+        case POWER_RESET_RELEASE:
+            if (elapsed >= QCC_BOOT_TIME_MS) {
+                initResult = CODEC_PENDING;
+                enterState(POWER_CODEC_INIT);
+                qccLinkSubmit(QCC_CMD_INIT, 0x01);
+                if (seqHooks.codecSettings) {
+                    seqHooks.codecSettings();
+                }
+            }
+            break;
+
+        case POWER_CODEC_INIT:
+            if (initResult == CODEC_OK) {
+                a2dpResult = CODEC_PENDING;
+                enterState(POWER_A2DP_ENABLE);
+                qccLinkSubmit(QCC_CMD_A2DP_ENABLE, 0x01);
+            } else if (initResult == CODEC_FAILED) {
+                fault("no ACK for INIT");
+            } else if (elapsed >= POWER_CODEC_TIMEOUT_MS) {
+                fault("timeout");
+            }
+            break;
+
+        case POWER_A2DP_ENABLE:
+            if (a2dpResult == CODEC_OK) {
+                xTimerStop(seqTimer, 0);
+                timeToReadyMs = millis() - requestedAt;
+                enterState(POWER_READY);
+                DEBUG_INFO("audio ready in %u ms", timeToReadyMs);
+            } else if (a2dpResult == CODEC_FAILED) {
+                fault("no ACK for A2DP enable");
+            } else if (elapsed >= POWER_CODEC_TIMEOUT_MS) {
+                fault("timeout");
+            }
+            break;
+
+        default:
+            // OFF, READY and FAULT are not sequenced
+            xTimerStop(seqTimer, 0);
+            break;
+    }
+}
+
+bool powerSeqBegin(uint8_t railPin, uint8_t resetPin, const PowerSeqHooks& hooks) {
+    rail = railPin;
+    reset = resetPin;
+    seqHooks = hooks;
+
+    seqTimer = arenaCreateTimer("powerseq", MILLIS_TO_TICKS(POWER_SEQ_POLL_MS),
+                                true, nullptr, seqStep);
+    if (!seqTimer) {
+        DEBUG_ERROR("power sequencer timer creation failed");
+        return false;
+    }
+    qccLinkOnComplete(codecComplete);
+    return true;
+}
+
+void powerSeqRequest(bool on) {
+    if (on) {
+        if (powerSeqRequested()) {
+            return;     // Already on or coming up
+        }
+        requestedAt = millis();
+        qccLinkReset();
+        setReset(LOW);
+        digitalWrite(rail, HIGH);
+        enterState(POWER_RAIL_ENABLE);
+        xTimerStart(seqTimer, 0);
+    } else {
+        xTimerStop(seqTimer, 0);
+        qccLinkReset();
+        setReset(LOW);
+        digitalWrite(rail, LOW);
+        if (state != POWER_OFF) {
+            enterState(POWER_OFF);
+        }
+    }
+}
+
+PowerState powerSeqState() {
+    return state;
+}
+
+const char* powerSeqStateName(PowerState s) {
+    return s < ARRAY_SIZE(stateNames) ? stateNames[s] : "?";
+}
+
+bool powerSeqRequested() {
+    PowerState s = state;
+    return s != POWER_OFF && s != POWER_FAULT;
+}
+
+bool powerSeqCodecUp() {
+    PowerState s = state;
+    return s >= POWER_CODEC_INIT && s <= POWER_READY;
+}
+
+uint32_t powerSeqTimeToReadyMs() {
+    return timeToReadyMs;
+}
@@ -0,0 +1,261 @@
+/**
+ * Hot-Path Profiler - see profiler.h
+ */
+
+#include "profiler.h"
+#include "config.h"
+#include "ble_link.h"
+
+#include <BLEServer.h>
+
+#if PROFILER_ENABLED
+
+#define PROF_BUCKETS            64      // Two per octave over the full u32 range
+#define PROF_DIAG_UUID          "87654321-4321-4321-4321-cba987654322"
+#define PROF_TASK_NAME          8
+
+#define MIC_FRAME_US            (AUDIO_FRAME_SIZE * 1000000UL / AUDIO_SAMPLE_RATE)
+
+struct SiteInfo {
+    const char* name;
+    uint32_t deadlineUs;        // 0: no deadline
+};
+
+// Each mic stage has to fit the frame period on its own, let alone together
+static const SiteInfo siteInfo[PROF_SITE_COUNT] = {
+    { "mic_frame",  MIC_FRAME_US },
+    { "vad",        MIC_FRAME_US },
+    { "noise",      MIC_FRAME_US },
+    { "agc",        MIC_FRAME_US },
+    { "display",    DISPLAY_UPDATE_RATE_MS * 1000UL },
+    { "ble_notify", BT_STATUS_MIN_INTERVAL_MS * 1000UL },
+    { "mic_stream", MIC_FRAME_US },
+};
+
+struct SiteData {
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint32_t misses;
+    uint64_t totalCycles;
+    uint32_t histogram[PROF_BUCKETS];
+};
+
+struct __attribute__((packed)) SitePacket {
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t avgCycles;
+    uint32_t maxCycles;
+    uint32_t p99Cycles;
+    uint16_t deadlineMisses;
+};
+
+struct __attribute__((packed)) TaskPacket {
+    char name[PROF_TASK_NAME];
+    uint8_t cpuPercent;
+    uint16_t stackFreeBytes;
+};
+
+static SiteData sites[PROF_SITE_COUNT];
+static portMUX_TYPE profLock = portMUX_INITIALIZER_UNLOCKED;
+
+static TaskStatus_t taskStatus[PROFILER_MAX_TASKS];
+
+// Bucket 2k holds [2^k, 1.5 * 2^k), bucket 2k + 1 holds [1.5 * 2^k, 2^(k+1))
+static uint8_t bucketOf(uint32_t cycles) {
+    if (cycles < 2) {
+        return (uint8_t)cycles;
+    }
+    uint8_t msb = 31 - __builtin_clz(cycles);
+    return (uint8_t)(2 * msb + ((cycles >> (msb - 1)) & 1));
+}
+
+static uint32_t bucketTop(uint8_t bucket) {
+    if (bucket < 2) {
+        return bucket;
+    }
+    uint8_t msb = bucket / 2;
+    uint32_t half = 1UL << (msb - 1);
+    uint32_t low = (1UL << msb) + ((bucket & 1) ? half : 0);
+    return low + (half - 1);
+}
+
+void profilerRecord(ProfileSite site, uint32_t cycles, uint32_t micros) {
+    if (site >= PROF_SITE_COUNT) {
+        return;
+    }
+    SiteData& s = sites[site];
+    uint8_t bucket = bucketOf(cycles);
+    bool missed = siteInfo[site].deadlineUs && micros > siteInfo[site].deadlineUs;
+
+    portENTER_CRITICAL(&profLock);
+    if (s.count == 0 || cycles < s.minCycles) {
+        s.minCycles = cycles;
+    }
+    if (cycles > s.maxCycles) {
+        s.maxCycles = cycles;
+    }
+    s.count++;
+    s.totalCycles += cycles;
+    s.histogram[bucket]++;
+    if (missed) {
+        s.misses++;
+    }
+    portEXIT_CRITICAL(&profLock);
+}
+
+ProfileStats profilerStats(ProfileSite site) {
+    ProfileStats out = {};
+    if (site >= PROF_SITE_COUNT) {
+        return out;
+    }
+
+    SiteData snapshot;
+    portENTER_CRITICAL(&profLock);
+    snapshot = sites[site];
+    portEXIT_CRITICAL(&profLock);
+
+    if (snapshot.count == 0) {
+        return out;
+    }
+    out.count = snapshot.count;
+    out.minCycles = snapshot.minCycles;
+    out.maxCycles = snapshot.maxCycles;
+    out.avgCycles = (uint32_t)(snapshot.totalCycles / snapshot.count);
+    out.deadlineMisses = snapshot.misses;
+
+    uint32_t target = snapshot.count - snapshot.count / 100;
+    uint32_t seen = 0;
+    for (uint8_t b = 0; b < PROF_BUCKETS; b++) {
+        seen += snapshot.histogram[b];
+        if (seen >= target) {
+            uint32_t top = bucketTop(b);
+            out.p99Cycles = top < snapshot.maxCycles ? top : snapshot.maxCycles;
+            break;
+        }
+    }
+    return out;
+}
+
+const char* profilerSiteName(ProfileSite site) {
+    return site < PROF_SITE_COUNT ? siteInfo[site].name : "?";
+}
+
+void profilerReset() {
+    portENTER_CRITICAL(&profLock);
+    memset(sites, 0, sizeof(sites));
+    portEXIT_CRITICAL(&profLock);
+}
+
+// Fills taskStatus; returns the task count. `percentOf` gets the run-time
+// divisor for one percent, or 0 when the kernel keeps no run-time counters.
+static UBaseType_t snapshotTasks(uint32_t* percentOf) {
+    *percentOf = 0;
+#if configUSE_TRACE_FACILITY
+    uint32_t totalRunTime = 0;
+    UBaseType_t count = uxTaskGetSystemState(taskStatus, PROFILER_MAX_TASKS, &totalRunTime);
+#if configGENERATE_RUN_TIME_STATS
+    *percentOf = totalRunTime / 100;
+#endif
+    return count;
+#else
+    return 0;
+#endif
+}
+
+static uint8_t taskPercent(const TaskStatus_t& task, uint32_t percentOf) {
+    if (!percentOf) {
+        return 0;
+    }
+    uint32_t percent = task.ulRunTimeCounter / percentOf;
+    return percent > 100 ? 100 : (uint8_t)percent;
+}
+
+void profilerPrint(Print& out) {
+    out.printf("%-11s %8s %8s %8s %8s %8s %6s  (cycles @ %u MHz)\n", "site", "count",
+               "min", "avg", "max", "p99", "miss", getCpuFrequencyMhz());
+    for (uint8_t i = 0; i < PROF_SITE_COUNT; i++) {
+        ProfileStats s = profilerStats((ProfileSite)i);
+        out.printf("%-11s %8u %8u %8u %8u %8u %6u\n", siteInfo[i].name, s.count,
+                   s.minCycles, s.avgCycles, s.maxCycles, s.p99Cycles, s.deadlineMisses);
+    }
+
+    uint32_t percentOf;
+    UBaseType_t count = snapshotTasks(&percentOf);
+    out.printf("%-16s %4s %5s %10s\n", "task", "prio", "cpu%", "stack free");
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t& task = taskStatus[i];
+        out.printf("%-16s %4u %5u %10u\n", task.pcTaskName, (unsigned)task.uxCurrentPriority,
+                   taskPercent(task, percentOf), (unsigned)task.usStackHighWaterMark);
+    }
+}
+
+// Rebuild the record on every read, in the BLE stack's task
+class DiagnosticsCallbacks : public BLECharacteristicCallbacks {
+    void onRead(BLECharacteristic* characteristic) {
+        bleLinkActivity();      // Diagnostics polling wants the short interval
+        static uint8_t record[4 + PROF_SITE_COUNT * sizeof(SitePacket) +
+                              1 + PROFILER_MAX_TASKS * sizeof(TaskPacket)];
+        size_t length = 0;
+
+        uint16_t mhz = (uint16_t)getCpuFrequencyMhz();
+        record[length++] = PROFILER_VERSION;
+        record[length++] = PROF_SITE_COUNT;
+        memcpy(&record[length], &mhz, sizeof(mhz));
+        length += sizeof(mhz);
+
+        for (uint8_t i = 0; i < PROF_SITE_COUNT; i++) {
+            ProfileStats s = profilerStats((ProfileSite)i);
+            SitePacket packet;
+            packet.count = s.count;
+            packet.minCycles = s.minCycles;
+            packet.avgCycles = s.avgCycles;
+            packet.maxCycles = s.maxCycles;
+            packet.p99Cycles = s.p99Cycles;
+            packet.deadlineMisses = s.deadlineMisses > 0xFFFF ? 0xFFFF : (uint16_t)s.deadlineMisses;
+            memcpy(&record[length], &packet, sizeof(packet));
+            length += sizeof(packet);
+        }
+
+        uint32_t percentOf;
+        UBaseType_t count = snapshotTasks(&percentOf);
+        record[length++] = (uint8_t)count;
+        for (UBaseType_t i = 0; i < count; i++) {
+            const TaskStatus_t& task = taskStatus[i];
+            TaskPacket packet;
+            strncpy(packet.name, task.pcTaskName, sizeof(packet.name));
+            packet.cpuPercent = taskPercent(task, percentOf);
+            packet.stackFreeBytes = task.usStackHighWaterMark > 0xFFFF ?
+                0xFFFF : (uint16_t)task.usStackHighWaterMark;
+            memcpy(&record[length], &packet, sizeof(packet));
+            length += sizeof(packet);
+        }
+        characteristic->setValue(record, length);
+    }
+};
+
+static DiagnosticsCallbacks diagnosticsCallbacks;
+
+void profilerDiagnosticsBegin(BLEService* service) {
+    BLECharacteristic* characteristic =
+        service->createCharacteristic(PROF_DIAG_UUID, BLECharacteristic::PROPERTY_READ);
+    characteristic->setCallbacks(&diagnosticsCallbacks);
+}
+
+#else // !PROFILER_ENABLED
+
+void profilerRecord(ProfileSite site, uint32_t cycles, uint32_t micros) {}
+
+ProfileStats profilerStats(ProfileSite site) {
+    return ProfileStats();
+}
+
+const char* profilerSiteName(ProfileSite site) {
+    return "?";
+}
+
+void profilerReset() {}
+void profilerPrint(Print& out) {}
+void profilerDiagnosticsBegin(BLEService* service) {}
+
+#endif // PROFILER_ENABLED
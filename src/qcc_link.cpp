@@ -0,0 +1,356 @@
+/**
+ * Framed, Acknowledged QCC5124 UART Link - see qcc_link.h
+ */
+
+#include "qcc_link.h"
+#include "config.h"
+#include "static_arena.h"
+#include "spsc_ring.h"
+
+#define QCC_SOF                 0xAA
+#define QCC_FRAME_OVERHEAD      5       // SOF, seq, cmd, len, crc
+#define QCC_TX_RING_SIZE        128
+#define QCC_RX_RING_SIZE        256
+
+struct QccCommand {
+    uint8_t cmd;
+    uint8_t length;
+    uint8_t payload[QCC_MAX_PAYLOAD];
+};
+
+// Submitted commands, FIFO. Shared with callers, guarded by queueLock.
+static QccCommand commandQueue[QCC_LINK_QUEUE_DEPTH];
+static uint8_t queueHead = 0;
+static uint8_t queueCount = 0;
+static portMUX_TYPE queueLock = portMUX_INITIALIZER_UNLOCKED;
+
+// Link task state
+static HardwareSerial* link = nullptr;
+static TaskHandle_t linkTaskHandle = nullptr;
+static QccCompleteCallback completeCallback = nullptr;
+static volatile bool resetRequested = false;
+
+static bool inFlight = false;
+static QccCommand current;
+static uint8_t currentSeq = 0;
+static uint8_t nextSeq = 0;
+static uint8_t attempts = 0;
+static uint32_t sentAt = 0;
+
+// Encoded bytes waiting for room in the UART FIFO; link task only
+static SpscRing<uint8_t, QCC_TX_RING_SIZE> txRing;
+
+// Filled by the UART event task in onReceive, parsed by the link task
+static SpscRing<uint8_t, QCC_RX_RING_SIZE> rxRing;
+
+static QccLinkStats stats;
+
+// Receive parser
+enum RxState : uint8_t { RX_SOF, RX_SEQ, RX_CMD, RX_LEN, RX_PAYLOAD, RX_CRC };
+static RxState rxState = RX_SOF;
+static uint8_t rxSeq, rxCmd, rxLen, rxCount, rxCrc;
+static uint8_t rxPayload[QCC_MAX_PAYLOAD];
+
+static uint8_t crc8Update(uint8_t crc, uint8_t data) {
+    crc ^= data;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+        crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+static inline bool isCoalescable(uint8_t cmd) {
+    return cmd == QCC_CMD_SET_VOLUME || cmd == QCC_CMD_MUTE;
+}
+
+static void txDrain() {
+    const uint8_t* bytes;
+    size_t span;
+    while ((span = txRing.peek(&bytes)) > 0) {
+        int room = link->availableForWrite();
+        if (room <= 0) {
+            return;     // Resume on the next wake-up
+        }
+        size_t chunk = (size_t)room < span ? (size_t)room : span;
+        link->write(bytes, chunk);
+        txRing.commitRead(chunk);
+    }
+}
+
+static void sendCurrent() {
+    if (txRing.space() < (size_t)current.length + QCC_FRAME_OVERHEAD) {
+        return;     // Ring still draining; the next pass retries
+    }
+
+    uint8_t frame[QCC_MAX_PAYLOAD + QCC_FRAME_OVERHEAD];
+    uint8_t length = 0;
+    uint8_t crc = 0;
+    frame[length++] = QCC_SOF;
+    frame[length++] = currentSeq;       crc = crc8Update(crc, currentSeq);
+    frame[length++] = current.cmd;      crc = crc8Update(crc, current.cmd);
+    frame[length++] = current.length;   crc = crc8Update(crc, current.length);
+    for (uint8_t i = 0; i < current.length; i++) {
+        frame[length++] = current.payload[i];
+        crc = crc8Update(crc, current.payload[i]);
+    }
+    frame[length++] = crc;
+    txRing.push(frame, length);
+
+    attempts++;
+    sentAt = millis();
+    stats.framesSent++;
+    txDrain();
+}
+
+static void finishCurrent(bool ok) {
+    inFlight = false;
+    if (completeCallback) {
+        completeCallback(current.cmd, ok);
+    }
+}
+
+static void startNext() {
+    portENTER_CRITICAL(&queueLock);
+    if (queueCount == 0) {
+        portEXIT_CRITICAL(&queueLock);
+        return;
+    }
+    current = commandQueue[queueHead];
+    queueHead = (queueHead + 1) % QCC_LINK_QUEUE_DEPTH;
+    queueCount--;
+    portEXIT_CRITICAL(&queueLock);
+
+    inFlight = true;
+    currentSeq = nextSeq++;
+    attempts = 0;
+    sendCurrent();
+}
+
+static void handleFrame() {
+    if (rxCmd != QCC_CMD_ACK && rxCmd != QCC_CMD_NAK) {
+        DEBUG_DEBUG("QCC event 0x%02x len %u", rxCmd, rxLen);
+        return;
+    }
+    if (!inFlight || rxSeq != currentSeq) {
+        return;     // Late answer to a frame we already retried or dropped
+    }
+
+    if (rxCmd == QCC_CMD_ACK) {
+        stats.acks++;
+        finishCurrent(true);
+    } else {
+        stats.naks++;
+        sentAt = millis() - QCC_ACK_TIMEOUT_MS;     // Retry on this pass
+    }
+}
+
+static void parseByte(uint8_t byte) {
+    switch (rxState) {
+        case RX_SOF:
+            if (byte == QCC_SOF) {
+                rxCrc = 0;
+                rxState = RX_SEQ;
+            }
+            break;
+        case RX_SEQ:
+            rxSeq = byte;
+            rxCrc = crc8Update(rxCrc, byte);
+            rxState = RX_CMD;
+            break;
+        case RX_CMD:
+            rxCmd = byte;
+            rxCrc = crc8Update(rxCrc, byte);
+            rxState = RX_LEN;
+            break;
+        case RX_LEN:
+            rxLen = byte;
+            rxCount = 0;
+            rxCrc = crc8Update(rxCrc, byte);
+            if (rxLen > QCC_MAX_PAYLOAD) {
+                stats.rxCrcErrors++;
+                rxState = RX_SOF;
+            } else {
+                rxState = rxLen ? RX_PAYLOAD : RX_CRC;
+            }
+            break;
+        case RX_PAYLOAD:
+            rxPayload[rxCount++] = byte;
+            rxCrc = crc8Update(rxCrc, byte);
+            if (rxCount == rxLen) {
+                rxState = RX_CRC;
+            }
+            break;
+        case RX_CRC:
+            if (byte == rxCrc) {
+                handleFrame();
+            } else {
+                stats.rxCrcErrors++;
+            }
+            rxState = RX_SOF;
+            break;
+    }
+}
+
+// UART event task: move everything the driver has into the ring in bulk
+static void receiveBytes() {
+    int available;
+    while ((available = link->available()) > 0) {
+        uint8_t* slot;
+        size_t span = rxRing.writeSpan(&slot);
+        if (!span) {
+            stats.rxOverflows++;    // Link task behind; the parser resyncs on SOF
+            return;
+        }
+        size_t n = link->read(slot, (size_t)available < span ? (size_t)available : span);
+        if (!n) {
+            return;
+        }
+        rxRing.commitWrite(n);
+    }
+}
+
+static void parseReceived() {
+    const uint8_t* bytes;
+    size_t span;
+    while ((span = rxRing.peek(&bytes)) > 0) {
+        for (size_t i = 0; i < span; i++) {
+            parseByte(bytes[i]);
+        }
+        rxRing.commitRead(span);
+    }
+}
+
+static TickType_t nextTimeout() {
+    if (!txRing.empty()) {
+        return MILLIS_TO_TICKS(1);      // Keep feeding the FIFO
+    }
+    if (!inFlight) {
+        return portMAX_DELAY;
+    }
+    int32_t remaining = (int32_t)(sentAt + QCC_ACK_TIMEOUT_MS - millis());
+    return remaining > 0 ? MILLIS_TO_TICKS(remaining) : 0;
+}
+
+static void linkTask(void* param) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, nextTimeout());
+
+        if (resetRequested) {
+            resetRequested = false;
+            inFlight = false;
+            txRing.clear();
+            rxRing.clear();
+            rxState = RX_SOF;
+        }
+
+        parseReceived();
+
+        if (inFlight && millis() - sentAt >= QCC_ACK_TIMEOUT_MS) {
+            if (attempts > QCC_MAX_RETRIES) {
+                DEBUG_WARN("QCC cmd 0x%02x dropped after %u attempts", current.cmd, attempts);
+                stats.dropped++;
+                finishCurrent(false);
+            } else {
+                stats.retries++;
+                sendCurrent();
+            }
+        }
+
+        if (!inFlight) {
+            startNext();
+        }
+        txDrain();
+    }
+}
+
+bool qccLinkBegin(HardwareSerial* uart) {
+    link = uart;
+    linkTaskHandle = arenaCreateTask(linkTask, "qcc", QCC_LINK_STACK_SIZE, nullptr,
+                                     TASK_PRIORITY_NORMAL);
+    if (!linkTaskHandle) {
+        DEBUG_ERROR("QCC link task creation failed");
+        return false;
+    }
+
+    // Wake the link task as soon as the UART driver has bytes for us
+    link->onReceive([]() {
+        receiveBytes();
+        xTaskNotifyGive(linkTaskHandle);
+    });
+    return true;
+}
+
+bool qccLinkSubmit(uint8_t cmd, const uint8_t* payload, uint8_t length) {
+    if (length > QCC_MAX_PAYLOAD || !linkTaskHandle) {
+        return false;
+    }
+
+    bool accepted = true;
+    portENTER_CRITICAL(&queueLock);
+
+    // Replace a queued command this one supersedes
+    QccCommand* slot = nullptr;
+    if (isCoalescable(cmd)) {
+        for (uint8_t i = 0; i < queueCount; i++) {
+            QccCommand& queued = commandQueue[(queueHead + i) % QCC_LINK_QUEUE_DEPTH];
+            if (queued.cmd == cmd) {
+                slot = &queued;
+                stats.coalesced++;
+                break;
+            }
+        }
+    }
+    if (!slot) {
+        if (queueCount < QCC_LINK_QUEUE_DEPTH) {
+            slot = &commandQueue[(queueHead + queueCount) % QCC_LINK_QUEUE_DEPTH];
+            queueCount++;
+        } else {
+            accepted = false;
+        }
+    }
+    if (slot) {
+        slot->cmd = cmd;
+        slot->length = length;
+        if (length) {
+            memcpy(slot->payload, payload, length);
+        }
+    }
+
+    portEXIT_CRITICAL(&queueLock);
+
+    if (accepted) {
+        xTaskNotifyGive(linkTaskHandle);
+    }
+    return accepted;
+}
+
+bool qccLinkSubmit(uint8_t cmd, uint8_t value) {
+    return qccLinkSubmit(cmd, &value, 1);
+}
+
+void qccLinkReset() {
+    portENTER_CRITICAL(&queueLock);
+    queueHead = 0;
+    queueCount = 0;
+    portEXIT_CRITICAL(&queueLock);
+
+    resetRequested = true;
+    if (linkTaskHandle) {
+        xTaskNotifyGive(linkTaskHandle);
+    }
+}
+
+void qccLinkOnComplete(QccCompleteCallback callback) {
+    completeCallback = callback;
+}
+
+bool qccLinkIdle() {
+    portENTER_CRITICAL(&queueLock);
+    bool idle = queueCount == 0 && !inFlight;
+    portEXIT_CRITICAL(&queueLock);
+    return idle;
+}
+
+QccLinkStats qccLinkStats() {
+    return stats;
+}
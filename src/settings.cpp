@@ -0,0 +1,174 @@
+/**
+ * Persisted User Settings - see settings.h
+ */
+
+#include "settings.h"
+#include "config.h"
+#include <Preferences.h>
+
+#define SETTINGS_KEY            "s"
+#define SETTINGS_VERSION        1
+
+// Stored layout. Bump SETTINGS_VERSION on any change; older blobs are
+// then ignored and the defaults loaded.
+struct __attribute__((packed)) SettingsBlob {
+    uint8_t version;
+    uint8_t volume;
+    uint8_t flags;
+    uint8_t nrLevel;
+    uint32_t vadThresholdQ30;
+};
+
+#define SETTINGS_FLAG_MUTED     0x01
+
+static Preferences store;
+static bool storeOpen = false;
+static portMUX_TYPE settingsLock = portMUX_INITIALIZER_UNLOCKED;
+
+static Settings current;
+static Settings saved;              // What the store holds
+static bool dirty = false;
+static uint32_t changedAt = 0;
+static uint32_t saveDelayMs = SETTINGS_SAVE_DELAY_MS;  // Doubles while writes fail
+static uint32_t writeCount = 0;
+
+static bool sameSettings(const Settings& a, const Settings& b) {
+    return a.volume == b.volume && a.muted == b.muted &&
+           a.vadThresholdQ30 == b.vadThresholdQ30 && a.nrLevel == b.nrLevel;
+}
+
+static bool load(Settings& out) {
+    SettingsBlob blob;
+    if (store.getBytesLength(SETTINGS_KEY) != sizeof(blob) ||
+        store.getBytes(SETTINGS_KEY, &blob, sizeof(blob)) != sizeof(blob)) {
+        return false;
+    }
+    if (blob.version != SETTINGS_VERSION || blob.volume > QCC_VOLUME_MAX || blob.nrLevel > 100) {
+        DEBUG_WARN("settings: layout v%u not usable, using defaults", blob.version);
+        return false;
+    }
+    out.volume = blob.volume;
+    out.muted = blob.flags & SETTINGS_FLAG_MUTED;
+    out.vadThresholdQ30 = blob.vadThresholdQ30;
+    out.nrLevel = blob.nrLevel;
+    return true;
+}
+
+static bool write(const Settings& s) {
+    SettingsBlob blob;
+    blob.version = SETTINGS_VERSION;
+    blob.volume = s.volume;
+    blob.flags = s.muted ? SETTINGS_FLAG_MUTED : 0;
+    blob.nrLevel = s.nrLevel;
+    blob.vadThresholdQ30 = s.vadThresholdQ30;
+
+    if (store.putBytes(SETTINGS_KEY, &blob, sizeof(blob)) == sizeof(blob)) {
+        saved = s;
+        writeCount++;
+        DEBUG_DEBUG("settings saved (write %u)", writeCount);
+        return true;
+    }
+    return false;
+}
+
+bool settingsBegin(const Settings& defaults) {
+    current = defaults;
+    storeOpen = store.begin(SETTINGS_NAMESPACE, false);
+    if (!storeOpen) {
+        DEBUG_ERROR("settings store unavailable, using defaults");
+        saved = current;
+        return false;
+    }
+    if (load(current)) {
+        DEBUG_INFO("settings: volume %u, muted %d, NR %u %%",
+                   current.volume, current.muted, current.nrLevel);
+    }
+    saved = current;
+    return true;
+}
+
+Settings settingsGet() {
+    portENTER_CRITICAL(&settingsLock);
+    Settings s = current;
+    portEXIT_CRITICAL(&settingsLock);
+    return s;
+}
+
+// Apply `change` to the RAM copy and restart the save delay
+template <typename Change>
+static void update(Change change) {
+    portENTER_CRITICAL(&settingsLock);
+    change(current);
+    dirty = true;
+    changedAt = millis();
+    portEXIT_CRITICAL(&settingsLock);
+}
+
+void settingsSetVolume(uint8_t volume) {
+    update([volume](Settings& s) { s.volume = volume; });
+}
+
+void settingsSetMuted(bool muted) {
+    update([muted](Settings& s) { s.muted = muted; });
+}
+
+void settingsSetVadThreshold(uint32_t thresholdQ30) {
+    update([thresholdQ30](Settings& s) { s.vadThresholdQ30 = thresholdQ30; });
+}
+
+void settingsSetNrLevel(uint8_t percent) {
+    update([percent](Settings& s) { s.nrLevel = percent; });
+}
+
+// Take the pending change if it is due (or `force`d)
+static bool takeDue(Settings* out, bool force) {
+    bool due = false;
+    portENTER_CRITICAL(&settingsLock);
+    if (dirty && (force || millis() - changedAt >= saveDelayMs)) {
+        dirty = false;
+        *out = current;
+        due = true;
+    }
+    portEXIT_CRITICAL(&settingsLock);
+    return due;
+}
+
+// After a write: back to the normal delay, or keep the change pending and
+// try again later. A change made meanwhile keeps its own timestamp.
+static void writeDone(bool ok) {
+    portENTER_CRITICAL(&settingsLock);
+    if (ok) {
+        saveDelayMs = SETTINGS_SAVE_DELAY_MS;
+    } else {
+        if (!dirty) {
+            dirty = true;
+            changedAt = millis();
+        }
+        saveDelayMs = saveDelayMs * 2 < SETTINGS_RETRY_MAX_MS ? saveDelayMs * 2 :
+                                                                 SETTINGS_RETRY_MAX_MS;
+    }
+    uint32_t delayMs = saveDelayMs;
+    portEXIT_CRITICAL(&settingsLock);
+    if (!ok) {
+        DEBUG_ERROR("settings write failed, retry in %u ms", delayMs);
+    }
+}
+
+static void save(bool force) {
+    Settings s;
+    if (storeOpen && takeDue(&s, force) && !sameSettings(s, saved)) {
+        writeDone(write(s));
+    }
+}
+
+void settingsService() {
+    save(false);
+}
+
+void settingsFlush() {
+    save(true);
+}
+
+uint32_t settingsWriteCount() {
+    return writeCount;
+}
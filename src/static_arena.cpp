@@ -0,0 +1,92 @@
+/**
+ * Static Memory Arena - see static_arena.h
+ */
+
+#include "static_arena.h"
+#include "config.h"
+
+alignas(16) static uint8_t arena[APP_ARENA_SIZE];
+static size_t arenaOffset = 0;
+static bool sealed = false;
+static uint32_t failures = 0;
+static portMUX_TYPE arenaLock = portMUX_INITIALIZER_UNLOCKED;
+
+void* arenaAlloc(size_t bytes, size_t align) {
+    void* block = nullptr;
+    portENTER_CRITICAL(&arenaLock);
+    size_t start = (arenaOffset + align - 1) & ~(align - 1);
+    if (!sealed && start + bytes <= sizeof(arena)) {
+        block = &arena[start];
+        arenaOffset = start + bytes;
+    } else {
+        failures++;
+    }
+    portEXIT_CRITICAL(&arenaLock);
+
+    if (!block) {
+        DEBUG_ERROR("arena: %u bytes refused (%s, %u/%u used)", (unsigned)bytes,
+                    sealed ? "sealed" : "full", (unsigned)arenaOffset, (unsigned)sizeof(arena));
+    }
+    return block;
+}
+
+void arenaSeal() {
+    portENTER_CRITICAL(&arenaLock);
+    sealed = true;
+    portEXIT_CRITICAL(&arenaLock);
+    DEBUG_INFO("arena sealed: %u of %u bytes used", (unsigned)arenaOffset, (unsigned)sizeof(arena));
+}
+
+size_t arenaUsed() {
+    return arenaOffset;
+}
+
+size_t arenaCapacity() {
+    return sizeof(arena);
+}
+
+uint32_t arenaFailures() {
+    return failures;
+}
+
+template <typename T>
+static T* arenaObject() {
+    return static_cast<T*>(arenaAlloc(sizeof(T), alignof(T)));
+}
+
+TaskHandle_t arenaCreateTask(TaskFunction_t function, const char* name, uint32_t stackBytes,
+                             void* param, UBaseType_t priority) {
+    StaticTask_t* tcb = arenaObject<StaticTask_t>();
+    StackType_t* stack = static_cast<StackType_t*>(arenaAlloc(stackBytes, 16));
+    if (!tcb || !stack) {
+        return nullptr;
+    }
+    // ESP-IDF stack depths are in bytes
+    return xTaskCreateStatic(function, name, stackBytes, param, priority, stack, tcb);
+}
+
+QueueHandle_t arenaCreateQueue(UBaseType_t length, UBaseType_t itemSize) {
+    StaticQueue_t* queue = arenaObject<StaticQueue_t>();
+    uint8_t* storage = static_cast<uint8_t*>(arenaAlloc(length * itemSize, 4));
+    if (!queue || !storage) {
+        return nullptr;
+    }
+    return xQueueCreateStatic(length, itemSize, storage, queue);
+}
+
+TimerHandle_t arenaCreateTimer(const char* name, TickType_t period, bool autoReload,
+                               void* id, TimerCallbackFunction_t callback) {
+    StaticTimer_t* timer = arenaObject<StaticTimer_t>();
+    if (!timer) {
+        return nullptr;
+    }
+    return xTimerCreateStatic(name, period, autoReload ? pdTRUE : pdFALSE, id, callback, timer);
+}
+
+SemaphoreHandle_t arenaCreateMutex() {
+    StaticSemaphore_t* mutex = arenaObject<StaticSemaphore_t>();
+    if (!mutex) {
+        return nullptr;
+    }
+    return xSemaphoreCreateMutexStatic(mutex);
+}
@@ -0,0 +1,381 @@
+/**
+ * Telemetry Time Series - see telemetry_log.h
+ */
+
+#include "telemetry_log.h"
+#include "config.h"
+#include "battery_monitor.h"
+#include "heap_monitor.h"
+#include "mic_pipeline.h"
+#include "ble_link.h"
+#include "charger.h"
+#include <BLEServer.h>
+#include <BLE2902.h>
+#include <esp_timer.h>
+
+#define TELEM_UUID              "87654321-4321-4321-4321-cba987654324"
+#define TELEM_DELTA_MAX         (TELEM_BLOCK_SIZE - sizeof(TelemetryBlockHeader))
+#define TELEM_PACKET_MAX        (BT_LINK_MTU - 3)
+#define TELEM_PACKET_HEADER     2
+
+// One slot when the feature is off, so the ring costs no RAM
+static constexpr uint16_t ringBlocks = FEATURE_TELEMETRY_LOG ? TELEM_BLOCK_COUNT : 1;
+
+static_assert(TELEM_BLOCK_SIZE > sizeof(TelemetryBlockHeader) + 5, "Block too small for a delta");
+static_assert(TELEM_PACKET_HEADER + TELEM_BLOCK_SIZE <= TELEM_PACKET_MAX,
+              "A block has to fit one notification");
+
+struct Block {
+    TelemetryBlockHeader header;
+    uint8_t deltas[TELEM_DELTA_MAX];
+};
+
+static const uint16_t periodS[TELEM_SERIES_COUNT] = {
+    TELEM_BATTERY_PERIOD_S,
+    TELEM_CHARGE_PERIOD_S,
+    TELEM_VAD_PERIOD_S,
+    TELEM_CPU_PERIOD_S,
+    TELEM_HEAP_PERIOD_S,
+    TELEM_RSSI_PERIOD_S,
+};
+
+// Everything below belongs to the telemetry task, except the requests
+// written by the BLE stack task
+static Block ring[ringBlocks];
+static uint16_t oldest = 0;
+static uint16_t retained = 0;
+static uint16_t nextSequence = 0;
+
+static Block open[TELEM_SERIES_COUNT];
+static int32_t last[TELEM_SERIES_COUNT];
+static uint32_t dueS[TELEM_SERIES_COUNT];
+
+static TelemetryLogStats stats;
+
+// Deltas since the previous sample of the rate series
+static uint32_t lastFrames = 0;
+static uint32_t lastVoiceFrames = 0;
+static uint64_t lastCpuTotal = 0;
+#if configGENERATE_RUN_TIME_STATS && INCLUDE_xTaskGetIdleTaskHandle
+static uint64_t lastCpuIdle = 0;
+#else
+static uint32_t lastCpuFrames = 0;
+#endif
+
+static BLECharacteristic* exportCharacteristic = nullptr;
+static BLE2902* exportCccd = nullptr;
+static volatile uint8_t pendingCommand = 0;
+static volatile uint16_t pendingFrom = 0;
+static volatile bool pendingHasFrom = false;
+static bool exporting = false;
+static uint16_t cursor = 0;             // Sequence of the next block to send
+
+static uint32_t uptimeS() {
+    return (uint32_t)(esp_timer_get_time() / 1000000);
+}
+
+// Zigzag varint; returns the byte count (1-5)
+static uint8_t encodeDelta(int32_t delta, uint8_t* out) {
+    uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+    uint8_t n = 0;
+    while (zigzag >= 0x80) {
+        out[n++] = (uint8_t)(zigzag | 0x80);
+        zigzag >>= 7;
+    }
+    out[n++] = (uint8_t)zigzag;
+    return n;
+}
+
+static void seal(TelemetrySeries series) {
+    Block& block = open[series];
+    if (!block.header.count) {
+        return;
+    }
+    block.header.sequence = nextSequence++;
+
+    if (retained == ringBlocks) {
+        oldest = (oldest + 1) % ringBlocks;
+        retained--;
+        stats.blocksOverwritten++;
+    }
+    Block& slot = ring[(oldest + retained) % ringBlocks];
+    memcpy(&slot, &block, sizeof(TelemetryBlockHeader) + block.header.bytes);
+    retained++;
+    block.header.count = 0;
+}
+
+static void append(TelemetrySeries series, uint32_t atS, int32_t value) {
+    Block& block = open[series];
+    TelemetryBlockHeader& header = block.header;
+    if (header.count) {
+        uint8_t code[5];
+        uint8_t n = encodeDelta(value - last[series], code);
+        bool contiguous = atS == header.startS + (uint32_t)header.count * header.periodS;
+        if (contiguous && header.count < 255 && header.bytes + n <= TELEM_DELTA_MAX) {
+            memcpy(&block.deltas[header.bytes], code, n);
+            header.bytes += n;
+            header.count++;
+            last[series] = value;
+            stats.samples++;
+            return;
+        }
+        seal(series);
+    }
+    header.series = series;
+    header.count = 1;
+    header.bytes = 0;
+    header.periodS = periodS[series];
+    header.startS = atS;
+    header.first = value;
+    last[series] = value;
+    stats.samples++;
+}
+
+static void sealAll() {
+    for (uint8_t s = 0; s < TELEM_SERIES_COUNT; s++) {
+        seal((TelemetrySeries)s);
+    }
+}
+
+static bool sampleVadDuty(int32_t* value) {
+    MicPipelineStats mic = micPipelineStats();
+    uint32_t frames = mic.frames - lastFrames;
+    uint32_t voice = mic.voiceFrames - lastVoiceFrames;
+    lastFrames = mic.frames;
+    lastVoiceFrames = mic.voiceFrames;
+    if (!FEATURE_VAD || !frames) {
+        return false;   // Mic off
+    }
+    *value = (int32_t)(voice * 100 / frames);
+    return true;
+}
+
+static bool sampleCpu(int32_t* value) {
+#if configGENERATE_RUN_TIME_STATS && INCLUDE_xTaskGetIdleTaskHandle
+    uint64_t total = portGET_RUN_TIME_COUNTER_VALUE();
+    uint64_t idle = ulTaskGetIdleRunTimeCounter();
+    uint64_t totalDelta = total - lastCpuTotal;
+    uint64_t busyDelta = totalDelta - (idle - lastCpuIdle);
+    lastCpuIdle = idle;
+#else
+    // No run-time counters: DSP cycles of the frames since the last sample
+    MicPipelineStats mic = micPipelineStats();
+    uint64_t total = (uint64_t)esp_timer_get_time() * getCpuFrequencyMhz();
+    uint64_t totalDelta = total - lastCpuTotal;
+    uint64_t busyDelta = (uint64_t)(mic.frames - lastCpuFrames) * mic.cyclesLast;
+    lastCpuFrames = mic.frames;
+#endif
+    bool valid = lastCpuTotal != 0 && totalDelta != 0;
+    lastCpuTotal = total;
+    if (!valid) {
+        return false;
+    }
+    *value = busyDelta >= totalDelta ? 100 : (int32_t)(busyDelta * 100 / totalDelta);
+    return true;
+}
+
+static bool sample(TelemetrySeries series, int32_t* value) {
+    switch (series) {
+        case TELEM_BATTERY_MV:
+            if (!FEATURE_BATTERY_MONITOR) return false;
+            *value = batteryMonitorMillivolts();
+            return true;
+        case TELEM_CHARGE:
+            *value = chargerState();
+            return true;
+        case TELEM_VAD_DUTY:
+            return sampleVadDuty(value);
+        case TELEM_CPU:
+            return sampleCpu(value);
+        case TELEM_HEAP_MIN:
+            *value = (int32_t)heapMonitorStats().minFree;
+            return true;
+        case TELEM_RSSI: {
+            // The reading requested at the previous sample
+            int8_t rssi = bleLinkRssi();
+            bleLinkRequestRssi();
+            *value = rssi;
+            return rssi != BLE_LINK_RSSI_NONE;
+        }
+        default:
+            return false;
+    }
+}
+
+// Ring position of the block with `sequence`; moves a cursor that fell
+// behind the ring up to the oldest block. Returns false past the newest.
+static bool locate(uint16_t* sequence, const Block** block) {
+    if (!retained) {
+        return false;
+    }
+    uint16_t first = ring[oldest].header.sequence;
+    if ((int16_t)(*sequence - first) < 0) {
+        *sequence = first;
+    }
+    uint16_t offset = *sequence - first;
+    if (offset >= retained) {
+        return false;
+    }
+    *block = &ring[(oldest + offset) % ringBlocks];
+    return true;
+}
+
+static size_t blockLength(const Block& block) {
+    return sizeof(TelemetryBlockHeader) + block.header.bytes;
+}
+
+static void startExport(bool hasFrom, uint16_t from) {
+    sealAll();
+    cursor = hasFrom ? from : (retained ? ring[oldest].header.sequence : nextSequence);
+    exporting = true;
+    DEBUG_INFO("telemetry export: %u blocks retained", retained);
+}
+
+// At most TELEM_EXPORT_BURST notifications per call, each packed with as
+// many whole blocks as the MTU allows
+static void exportBurst(bool connected) {
+    if (!connected || !exportCccd->getNotifications()) {
+        exporting = false;
+        return;
+    }
+    size_t packetMax = bleLinkMtu() - 3;
+    if (packetMax > TELEM_PACKET_MAX) {
+        packetMax = TELEM_PACKET_MAX;
+    }
+    if (packetMax < TELEM_PACKET_HEADER + TELEM_BLOCK_SIZE) {
+        DEBUG_WARN("telemetry export needs an MTU of %u", TELEM_PACKET_HEADER + TELEM_BLOCK_SIZE + 3);
+        exporting = false;
+        return;
+    }
+
+    static uint8_t packet[TELEM_PACKET_MAX];
+    bleLinkActivity();      // Short interval for the batch
+    for (uint8_t i = 0; i < TELEM_EXPORT_BURST && exporting; i++) {
+        size_t length = TELEM_PACKET_HEADER;
+        uint8_t blocks = 0;
+        const Block* block;
+        while (locate(&cursor, &block) && length + blockLength(*block) <= packetMax) {
+            memcpy(&packet[length], block, blockLength(*block));
+            length += blockLength(*block);
+            blocks++;
+            cursor++;
+        }
+        packet[0] = TELEM_VERSION;
+        packet[1] = blocks;
+        exportCharacteristic->setValue(packet, length);
+        exportCharacteristic->notify();
+        exporting = blocks != 0;    // The empty batch marks the end
+    }
+}
+
+class ExportCallbacks : public BLECharacteristicCallbacks {
+    void onWrite(BLECharacteristic* characteristic) {
+        // BLE stack task: leave the request for the telemetry task
+        bleLinkActivity();
+        const uint8_t* value = characteristic->getData();
+        size_t length = characteristic->getLength();
+        if (length == 3 && value[0] == TELEM_CMD_EXPORT) {
+            pendingFrom = value[1] | (value[2] << 8);
+            pendingHasFrom = true;
+        } else if (length == 1 && (value[0] == TELEM_CMD_EXPORT || value[0] == TELEM_CMD_CLEAR)) {
+            pendingHasFrom = false;
+        } else {
+            DEBUG_WARN("rejected telemetry command, %u bytes", (unsigned)length);
+            return;
+        }
+        pendingCommand = value[0];
+    }
+};
+
+static ExportCallbacks exportCallbacks;
+
+void telemetryLogBegin() {
+    uint32_t now = uptimeS();
+    for (uint8_t s = 0; s < TELEM_SERIES_COUNT; s++) {
+        open[s].header.count = 0;
+        dueS[s] = now;
+    }
+    int32_t discard;
+    sampleCpu(&discard);    // Baselines for the rate series
+    sampleVadDuty(&discard);
+}
+
+void telemetryLogBleBegin(BLEService* service) {
+    if constexpr (!FEATURE_TELEMETRY_LOG) {
+        return;
+    }
+    exportCharacteristic = service->createCharacteristic(
+        TELEM_UUID, BLECharacteristic::PROPERTY_WRITE | BLECharacteristic::PROPERTY_NOTIFY);
+    static BLE2902 cccd;
+    exportCccd = &cccd;
+    exportCharacteristic->addDescriptor(exportCccd);
+    exportCharacteristic->setCallbacks(&exportCallbacks);
+}
+
+void telemetryLogService(bool connected) {
+    if constexpr (!FEATURE_TELEMETRY_LOG) {
+        return;
+    }
+
+    uint32_t now = uptimeS();
+    for (uint8_t s = 0; s < TELEM_SERIES_COUNT; s++) {
+        TelemetrySeries series = (TelemetrySeries)s;
+        if ((int32_t)(now - dueS[s]) < 0) {
+            continue;
+        }
+        uint32_t at = dueS[s];
+        if (now - at >= periodS[s]) {
+            at = now;       // Stalled for a whole period; start a new block
+        }
+        dueS[s] = at + periodS[s];
+
+        int32_t value;
+        if (sample(series, &value)) {
+            append(series, at, value);
+        } else {
+            seal(series);   // A gap ends the block
+        }
+    }
+
+    uint8_t command = pendingCommand;
+    if (command) {
+        pendingCommand = 0;
+        if (command == TELEM_CMD_CLEAR) {
+            telemetryLogClear();
+        } else if (exportCharacteristic) {
+            startExport(pendingHasFrom, pendingFrom);
+        }
+    }
+    if (exporting) {
+        exportBurst(connected);
+    }
+}
+
+void telemetryLogPrint(Print& out) {
+    sealAll();
+    for (uint16_t i = 0; i < retained; i++) {
+        const Block& block = ring[(oldest + i) % ringBlocks];
+        const uint8_t* bytes = (const uint8_t*)&block;
+        out.print("telem ");
+        for (size_t b = 0; b < blockLength(block); b++) {
+            out.printf("%02x", bytes[b]);
+        }
+        out.println();
+    }
+    out.printf("telem end, %u blocks, %u overwritten\n", retained, stats.blocksOverwritten);
+}
+
+void telemetryLogClear() {
+    for (uint8_t s = 0; s < TELEM_SERIES_COUNT; s++) {
+        open[s].header.count = 0;
+    }
+    oldest = 0;
+    retained = 0;
+    exporting = false;
+}
+
+TelemetryLogStats telemetryLogStats() {
+    TelemetryLogStats snapshot = stats;
+    snapshot.blocks = retained;
+    return snapshot;
+}